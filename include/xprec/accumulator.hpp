@@ -0,0 +1,153 @@
+/* Small double-double arithmetic library - lazily normalized sums
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cmath>
+
+#include "ddouble.hpp"
+
+namespace xprec {
+
+/**
+ * Lazily normalized sum of double-double terms.
+ *
+ * The DDouble operators renormalize their result after every operation,
+ * even if it only feeds into the next addition.  Instead, the accumulator
+ * adds the hi part of each term to a pending double using an error-free
+ * transformation, but merely adds up the rounding errors and lo parts in a
+ * second double.  Only after RENORM updates, or when the value is read, the
+ * pending pair is normalized and added to the total.  The rough cost in
+ * floating point operations (flops) is as follows:
+ *
+ *   | (op)                          | Accumulator | DDouble operators |
+ *   |-------------------------------|------------:|------------------:|
+ *   | += double                     |     7 flops |          10 flops |
+ *   | += DDouble                    |     8 flops |          20 flops |
+ *   | add_product(double, double)   |    10 flops |          22 flops |
+ *   | add_product(DDouble, double)  |    11 flops |          26 flops |
+ *   | add_product(DDouble, DDouble) |    14 flops |          29 flops |
+ *
+ * plus 6 flops when read, and 20 more flops if the sum has been started at
+ * a nonzero value or renormalized.  The rounding errors in the pending lo
+ * part grow quadratically with the number of updates, which is why at most
+ * RENORM updates are allowed between normalizations: the error of a sum of
+ * n terms is then bounded by about min(n (n + 1), 160 + n/2) u² times the
+ * sum of the magnitudes of the terms (not counting the initial value),
+ * compared to 3n u² for a loop over the DDouble operators.  For products,
+ * the error of the multiplication (see DDouble) is added.  Without FMA (see
+ * XPREC_USE_FMA), products use Dekker's algorithm and cost 15 flops more.
+ */
+class Accumulator {
+public:
+    /** Maximum number of updates between normalizations */
+    static constexpr unsigned RENORM = 8;
+
+    /** Start the sum at zero */
+    constexpr Accumulator() : _total(0.0), _hi(0.0), _lo(0.0), _count(0) { }
+
+    /** Start the sum at the given value */
+    constexpr Accumulator(DDouble x)
+        : _total(x), _hi(0.0), _lo(0.0), _count(0)
+    { }
+
+    /** Add term to the sum */
+    Accumulator &operator+=(double y) { return add(ExDouble(_hi) + y); }
+
+    /** Add term to the sum */
+    Accumulator &operator+=(DDouble y)
+    {
+        return add(ExDouble(_hi) + y.hi(), y.lo());
+    }
+
+    /** Subtract term from the sum */
+    Accumulator &operator-=(double y) { return *this += -y; }
+
+    /** Subtract term from the sum */
+    Accumulator &operator-=(DDouble y) { return *this += -y; }
+
+    /** Add exact product a * b to the sum (Dot2 of Ogita, Rump and Oishi) */
+    Accumulator &add_product(double a, double b)
+    {
+        DDouble p = ExDouble(a) * b;
+        return add(ExDouble(_hi) + p.hi(), p.lo());
+    }
+
+    /** Add product a * b to the sum, truncated as in operator*. */
+    Accumulator &add_product(DDouble a, double b)
+    {
+        DDouble p = ExDouble(a.hi()) * b;
+#if XPREC_USE_FMA
+        double lo = std::fma(a.lo(), b, p.lo());
+#else
+        double lo = a.lo() * b + p.lo();
+#endif
+        return add(ExDouble(_hi) + p.hi(), lo);
+    }
+
+    /** Add product a * b to the sum, truncated as in operator*. */
+    Accumulator &add_product(DDouble a, DDouble b)
+    {
+        DDouble p = ExDouble(a.hi()) * b.hi();
+#if XPREC_USE_FMA
+        double tl1 = std::fma(a.hi(), b.lo(), a.lo() * b.lo());
+        double lo = std::fma(a.lo(), b.hi(), tl1) + p.lo();
+#else
+        double lo = (a.hi() * b.lo() + a.lo() * b.hi()) + p.lo();
+#endif
+        return add(ExDouble(_hi) + p.hi(), lo);
+    }
+
+    /** Add product a * b to the sum, truncated as in operator*. */
+    Accumulator &add_product(double a, DDouble b)
+    {
+        return add_product(b, a);
+    }
+
+    /** Return the normalized sum */
+    DDouble value() const
+    {
+        DDouble pending = ExDouble(_hi) + _lo;
+        return _total.hi() == 0.0 ? pending : _total + pending;
+    }
+
+    /** Return the normalized sum */
+    explicit operator DDouble() const { return value(); }
+
+    /** Normalize the pending terms and add them to the total */
+    void normalize()
+    {
+        _total = value();
+        _hi = 0.0;
+        _lo = 0.0;
+        _count = 0;
+    }
+
+private:
+    /** Set pending hi part to s.hi(), adding s.lo() to the lo part */
+    Accumulator &add(DDouble s)
+    {
+        _hi = s.hi();
+        _lo += s.lo();
+        if (++_count == RENORM)
+            normalize();
+        return *this;
+    }
+
+    /** Set pending hi part to s.hi(), adding s.lo() and lo to the lo part */
+    Accumulator &add(DDouble s, double lo)
+    {
+        _hi = s.hi();
+        _lo += s.lo() + lo;
+        if (++_count == RENORM)
+            normalize();
+        return *this;
+    }
+
+    DDouble _total;
+    double _hi, _lo;
+    unsigned _count;
+};
+
+} /* namespace xprec */
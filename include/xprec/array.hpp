@@ -0,0 +1,619 @@
+/* Small double-double arithmetic library - structure-of-arrays storage
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#include "ddouble.hpp"
+
+namespace xprec {
+
+class DDoubleRef;
+class DDoubleSpan;
+class ConstDDoubleSpan;
+class DDoubleArray;
+
+/**
+ * Proxy reference to a double-double stored in split hi/lo arrays.
+ *
+ * Behaves like a `DDouble &`: it converts implicitly to DDouble, so it can be
+ * passed to all functions and operators taking DDouble, and it supports
+ * assignment and the compound assignment operators.
+ */
+class DDoubleRef {
+public:
+    constexpr DDoubleRef(double &hi, double &lo) : _hi(hi), _lo(lo) { }
+
+    DDoubleRef(const DDoubleRef &) = default;
+
+    /** Assignment writes through to the referenced element */
+    DDoubleRef &operator=(const DDoubleRef &y) { return *this = DDouble(y); }
+
+    DDoubleRef &operator=(DDouble y)
+    {
+        _hi = y.hi();
+        _lo = y.lo();
+        return *this;
+    }
+
+    operator DDouble() const { return DDouble(_hi, _lo); }
+
+    /** Get high part of the referenced ddouble */
+    double hi() const { return _hi; }
+
+    /** Get low part of the referenced ddouble */
+    double lo() const { return _lo; }
+
+    // Many operators of DDouble are hidden friends, which argument-dependent
+    // lookup does not find through the proxy, and the remaining ones are
+    // ambiguous, since they require a conversion on either side.  So we
+    // provide the full set here.
+    friend DDouble operator+(DDoubleRef x) { return DDouble(x); }
+    friend DDouble operator-(DDoubleRef x) { return -DDouble(x); }
+
+#define XPREC_REF_BINARY_OP_(op, ret)                                          \
+    friend ret operator op(DDoubleRef x, DDoubleRef y)                         \
+    {                                                                          \
+        return DDouble(x) op DDouble(y);                                       \
+    }                                                                          \
+    friend ret operator op(DDoubleRef x, DDouble y) { return DDouble(x) op y; } \
+    friend ret operator op(DDouble x, DDoubleRef y) { return x op DDouble(y); } \
+    friend ret operator op(DDoubleRef x, double y) { return DDouble(x) op y; }  \
+    friend ret operator op(double x, DDoubleRef y) { return x op DDouble(y); }
+
+    XPREC_REF_BINARY_OP_(+, DDouble)
+    XPREC_REF_BINARY_OP_(-, DDouble)
+    XPREC_REF_BINARY_OP_(*, DDouble)
+    XPREC_REF_BINARY_OP_(/, DDouble)
+
+    XPREC_REF_BINARY_OP_(==, bool)
+    XPREC_REF_BINARY_OP_(!=, bool)
+    XPREC_REF_BINARY_OP_(<=, bool)
+    XPREC_REF_BINARY_OP_(<, bool)
+    XPREC_REF_BINARY_OP_(>=, bool)
+    XPREC_REF_BINARY_OP_(>, bool)
+
+#undef XPREC_REF_BINARY_OP_
+
+    friend DDouble operator*(DDoubleRef x, PowerOfTwo y)
+    {
+        return DDouble(x) * y;
+    }
+
+    friend DDouble operator*(PowerOfTwo x, DDoubleRef y)
+    {
+        return x * DDouble(y);
+    }
+
+    friend DDouble operator/(DDoubleRef x, PowerOfTwo y)
+    {
+        return DDouble(x) / y;
+    }
+
+    DDoubleRef &operator+=(double y) { return *this = DDouble(*this) + y; }
+    DDoubleRef &operator-=(double y) { return *this = DDouble(*this) - y; }
+    DDoubleRef &operator*=(double y) { return *this = DDouble(*this) * y; }
+    DDoubleRef &operator/=(double y) { return *this = DDouble(*this) / y; }
+
+    DDoubleRef &operator+=(DDouble y) { return *this = DDouble(*this) + y; }
+    DDoubleRef &operator-=(DDouble y) { return *this = DDouble(*this) - y; }
+    DDoubleRef &operator*=(DDouble y) { return *this = DDouble(*this) * y; }
+    DDoubleRef &operator/=(DDouble y) { return *this = DDouble(*this) / y; }
+
+    DDoubleRef &operator*=(PowerOfTwo y) { return *this = DDouble(*this) * y; }
+    DDoubleRef &operator/=(PowerOfTwo y) { return *this = DDouble(*this) / y; }
+
+    friend void swap(DDoubleRef x, DDoubleRef y)
+    {
+        DDouble tmp = x;
+        x = y;
+        y = tmp;
+    }
+
+private:
+    double &_hi;
+    double &_lo;
+};
+
+namespace _internal {
+
+/**
+ * Random access iterator over a span of split double-doubles.
+ */
+template <typename Span>
+class SoAIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = DDouble;
+    using difference_type = std::ptrdiff_t;
+    using reference = decltype(std::declval<Span>()[0]);
+    using pointer = void;
+
+    SoAIterator() : _span(), _i(0) { }
+    SoAIterator(Span span, size_t i) : _span(span), _i(i) { }
+
+    reference operator*() const { return _span[_i]; }
+    reference operator[](difference_type n) const { return _span[_i + n]; }
+
+    SoAIterator &operator++() { ++_i; return *this; }
+    SoAIterator &operator--() { --_i; return *this; }
+    SoAIterator operator++(int) { return SoAIterator(_span, _i++); }
+    SoAIterator operator--(int) { return SoAIterator(_span, _i--); }
+
+    SoAIterator &operator+=(difference_type n) { _i += n; return *this; }
+    SoAIterator &operator-=(difference_type n) { _i -= n; return *this; }
+
+    friend SoAIterator operator+(SoAIterator it, difference_type n)
+    {
+        return it += n;
+    }
+
+    friend SoAIterator operator+(difference_type n, SoAIterator it)
+    {
+        return it += n;
+    }
+
+    friend SoAIterator operator-(SoAIterator it, difference_type n)
+    {
+        return it -= n;
+    }
+
+    friend difference_type operator-(SoAIterator a, SoAIterator b)
+    {
+        return difference_type(a._i) - difference_type(b._i);
+    }
+
+    friend bool operator==(SoAIterator a, SoAIterator b) { return a._i == b._i; }
+    friend bool operator!=(SoAIterator a, SoAIterator b) { return a._i != b._i; }
+    friend bool operator<(SoAIterator a, SoAIterator b) { return a._i < b._i; }
+    friend bool operator>(SoAIterator a, SoAIterator b) { return a._i > b._i; }
+    friend bool operator<=(SoAIterator a, SoAIterator b) { return a._i <= b._i; }
+    friend bool operator>=(SoAIterator a, SoAIterator b) { return a._i >= b._i; }
+
+private:
+    Span _span;
+    size_t _i;
+};
+
+/** Alignment of the hi and lo arrays, in bytes (one cache line). */
+constexpr size_t SOA_ALIGNMENT = 64;
+
+/** Number of doubles fitting into one alignment unit. */
+constexpr size_t SOA_ALIGNMENT_DOUBLES = SOA_ALIGNMENT / sizeof(double);
+
+/**
+ * Allocate n doubles, aligned to SOA_ALIGNMENT bytes.
+ *
+ * We over-allocate and store the original pointer just in front of the
+ * aligned block, since aligned operator new is only available from C++17.
+ */
+inline double *aligned_alloc_doubles(size_t n)
+{
+    if (n == 0)
+        return nullptr;
+
+    size_t bytes = n * sizeof(double) + SOA_ALIGNMENT + sizeof(void *);
+    char *raw = static_cast<char *>(::operator new(bytes));
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw + sizeof(void *));
+    uintptr_t aligned = (start + SOA_ALIGNMENT - 1) & ~(SOA_ALIGNMENT - 1);
+    reinterpret_cast<void **>(aligned)[-1] = raw;
+    return reinterpret_cast<double *>(aligned);
+}
+
+/** Free memory obtained from aligned_alloc_doubles() */
+inline void aligned_free_doubles(double *ptr)
+{
+    if (ptr != nullptr)
+        ::operator delete(reinterpret_cast<void **>(ptr)[-1]);
+}
+
+} // namespace _internal
+
+/**
+ * Non-owning view of read-only double-doubles stored as split hi/lo arrays.
+ *
+ * The i-th element is DDouble(hi()[i], lo()[i]).  Elements are returned by
+ * value.
+ */
+class ConstDDoubleSpan {
+public:
+    using value_type = DDouble;
+    using size_type = size_t;
+    using reference = DDouble;
+    using const_reference = DDouble;
+    using iterator = _internal::SoAIterator<ConstDDoubleSpan>;
+    using const_iterator = iterator;
+
+    constexpr ConstDDoubleSpan() : _hi(nullptr), _lo(nullptr), _size(0) { }
+
+    /**
+     * Construct span from hi and lo arrays of (at least) size elements.
+     *
+     * WARNING: You MUST ensure that every element is normalized, i.e., that
+     * abs(hi[i]) > epsilon * abs(lo[i]).
+     */
+    constexpr ConstDDoubleSpan(const double *hi, const double *lo, size_t size)
+        : _hi(hi), _lo(lo), _size(size)
+    { }
+
+    /** Number of elements */
+    constexpr size_t size() const { return _size; }
+
+    /** True if the span has no elements */
+    constexpr bool empty() const { return _size == 0; }
+
+    /** Array of the high parts */
+    constexpr const double *hi() const { return _hi; }
+
+    /** Array of the low parts */
+    constexpr const double *lo() const { return _lo; }
+
+    DDouble operator[](size_t i) const { return DDouble(_hi[i], _lo[i]); }
+
+    /** Return view of the elements [offset, offset + count) */
+    ConstDDoubleSpan subspan(size_t offset, size_t count) const
+    {
+        return ConstDDoubleSpan(_hi + offset, _lo + offset, count);
+    }
+
+    iterator begin() const { return iterator(*this, 0); }
+    iterator end() const { return iterator(*this, _size); }
+
+private:
+    const double *_hi;
+    const double *_lo;
+    size_t _size;
+};
+
+/**
+ * Non-owning view of double-doubles stored as split hi/lo arrays.
+ *
+ * The i-th element is DDouble(hi()[i], lo()[i]).  Element access returns a
+ * DDoubleRef proxy, which can be read and assigned to like a DDouble.
+ */
+class DDoubleSpan {
+public:
+    using value_type = DDouble;
+    using size_type = size_t;
+    using reference = DDoubleRef;
+    using const_reference = DDouble;
+    using iterator = _internal::SoAIterator<DDoubleSpan>;
+    using const_iterator = ConstDDoubleSpan::iterator;
+
+    constexpr DDoubleSpan() : _hi(nullptr), _lo(nullptr), _size(0) { }
+
+    /** Construct span from hi and lo arrays of (at least) size elements. */
+    constexpr DDoubleSpan(double *hi, double *lo, size_t size)
+        : _hi(hi), _lo(lo), _size(size)
+    { }
+
+    constexpr operator ConstDDoubleSpan() const
+    {
+        return ConstDDoubleSpan(_hi, _lo, _size);
+    }
+
+    /** Number of elements */
+    constexpr size_t size() const { return _size; }
+
+    /** True if the span has no elements */
+    constexpr bool empty() const { return _size == 0; }
+
+    /** Array of the high parts */
+    constexpr double *hi() const { return _hi; }
+
+    /** Array of the low parts */
+    constexpr double *lo() const { return _lo; }
+
+    DDoubleRef operator[](size_t i) const { return DDoubleRef(_hi[i], _lo[i]); }
+
+    /** Return view of the elements [offset, offset + count) */
+    DDoubleSpan subspan(size_t offset, size_t count) const
+    {
+        return DDoubleSpan(_hi + offset, _lo + offset, count);
+    }
+
+    /** Set all elements to x */
+    void fill(DDouble x) const
+    {
+        for (size_t i = 0; i != _size; ++i) {
+            _hi[i] = x.hi();
+            _lo[i] = x.lo();
+        }
+    }
+
+    iterator begin() const { return iterator(*this, 0); }
+    iterator end() const { return iterator(*this, _size); }
+
+private:
+    double *_hi;
+    double *_lo;
+    size_t _size;
+};
+
+/**
+ * Container for double-doubles with split hi/lo storage.
+ *
+ * Where `std::vector<DDouble>` stores the hi and lo parts interleaved, this
+ * container stores them in two separate arrays, each aligned to 64 bytes.
+ * This "structure of arrays" layout allows loading several hi or lo parts
+ * into a SIMD register without shuffling.
+ *
+ * Element access returns a DDoubleRef proxy, such that most code written for
+ * DDouble works unchanged.  Use hi() and lo() to access the raw arrays and
+ * span() or the conversion operators to obtain non-owning views.
+ */
+class DDoubleArray {
+public:
+    using value_type = DDouble;
+    using size_type = size_t;
+    using reference = DDoubleRef;
+    using const_reference = DDouble;
+    using iterator = DDoubleSpan::iterator;
+    using const_iterator = ConstDDoubleSpan::iterator;
+
+    /** Construct empty array */
+    DDoubleArray() : _hi(nullptr), _lo(nullptr), _size(0), _capacity(0) { }
+
+    /** Construct array of n copies of value */
+    explicit DDoubleArray(size_t n, DDouble value = 0.0) : DDoubleArray()
+    {
+        resize(n, value);
+    }
+
+    /** Construct array from the range [first, last) in AoS layout */
+    DDoubleArray(const DDouble *first, const DDouble *last) : DDoubleArray()
+    {
+        size_t n = last - first;
+        _allocate(n);
+        for (size_t i = 0; i != n; ++i) {
+            _hi[i] = first[i].hi();
+            _lo[i] = first[i].lo();
+        }
+        _size = n;
+    }
+
+    DDoubleArray(std::initializer_list<DDouble> init)
+        : DDoubleArray(init.begin(), init.end())
+    { }
+
+    /** Construct array as a copy of a span */
+    explicit DDoubleArray(ConstDDoubleSpan other) : DDoubleArray()
+    {
+        _allocate(other.size());
+        _copy(other);
+    }
+
+    DDoubleArray(const DDoubleArray &other) : DDoubleArray(other.cspan()) { }
+
+    DDoubleArray(DDoubleArray &&other) noexcept : DDoubleArray()
+    {
+        swap(*this, other);
+    }
+
+    DDoubleArray &operator=(const DDoubleArray &other)
+    {
+        if (this != &other) {
+            if (_capacity < other.size()) {
+                DDoubleArray tmp(other);
+                swap(*this, tmp);
+            } else {
+                _copy(other.cspan());
+            }
+        }
+        return *this;
+    }
+
+    DDoubleArray &operator=(DDoubleArray &&other) noexcept
+    {
+        swap(*this, other);
+        return *this;
+    }
+
+    ~DDoubleArray() { _internal::aligned_free_doubles(_hi); }
+
+    friend void swap(DDoubleArray &x, DDoubleArray &y) noexcept
+    {
+        std::swap(x._hi, y._hi);
+        std::swap(x._lo, y._lo);
+        std::swap(x._size, y._size);
+        std::swap(x._capacity, y._capacity);
+    }
+
+    /** Number of elements */
+    size_t size() const { return _size; }
+
+    /** True if the array has no elements */
+    bool empty() const { return _size == 0; }
+
+    /** Number of elements that can be held without reallocation */
+    size_t capacity() const { return _capacity; }
+
+    /**
+     * Change size of the array to n.
+     *
+     * Existing elements are preserved, new elements are set to value.
+     */
+    void resize(size_t n, DDouble value = 0.0)
+    {
+        reserve(n);
+        for (size_t i = _size; i < n; ++i) {
+            _hi[i] = value.hi();
+            _lo[i] = value.lo();
+        }
+        _size = n;
+    }
+
+    /** Ensure the array can hold n elements without reallocation */
+    void reserve(size_t n)
+    {
+        if (n <= _capacity)
+            return;
+
+        DDoubleArray tmp;
+        tmp._allocate(n);
+        tmp._copy(cspan());
+        swap(*this, tmp);
+    }
+
+    /** Remove all elements */
+    void clear() { _size = 0; }
+
+    /** Array of the high parts, aligned to 64 bytes */
+    double *hi() { return _hi; }
+    const double *hi() const { return _hi; }
+
+    /** Array of the low parts, aligned to 64 bytes */
+    double *lo() { return _lo; }
+    const double *lo() const { return _lo; }
+
+    DDoubleRef operator[](size_t i) { return DDoubleRef(_hi[i], _lo[i]); }
+    DDouble operator[](size_t i) const { return DDouble(_hi[i], _lo[i]); }
+
+    /** Return non-owning view of the array */
+    DDoubleSpan span() { return DDoubleSpan(_hi, _lo, _size); }
+    ConstDDoubleSpan span() const { return cspan(); }
+    ConstDDoubleSpan cspan() const { return ConstDDoubleSpan(_hi, _lo, _size); }
+
+    operator DDoubleSpan() { return span(); }
+    operator ConstDDoubleSpan() const { return cspan(); }
+
+    iterator begin() { return span().begin(); }
+    iterator end() { return span().end(); }
+    const_iterator begin() const { return cspan().begin(); }
+    const_iterator end() const { return cspan().end(); }
+
+private:
+    void _allocate(size_t n)
+    {
+        // Round capacity up such that the lo array is also aligned.
+        using _internal::SOA_ALIGNMENT_DOUBLES;
+        size_t cap = (n + SOA_ALIGNMENT_DOUBLES - 1) / SOA_ALIGNMENT_DOUBLES
+                     * SOA_ALIGNMENT_DOUBLES;
+
+        _hi = _internal::aligned_alloc_doubles(2 * cap);
+        _lo = _hi + cap;
+        _capacity = cap;
+    }
+
+    void _copy(ConstDDoubleSpan other)
+    {
+        for (size_t i = 0; i != other.size(); ++i) {
+            _hi[i] = other.hi()[i];
+            _lo[i] = other.lo()[i];
+        }
+        _size = other.size();
+    }
+
+    double *_hi;
+    double *_lo;
+    size_t _size;
+    size_t _capacity;
+};
+
+/**
+ * Instruction set used by the array functions.
+ *
+ * SCALAR denotes the kernels compiled for the instruction set the library
+ * itself was built for, which is scalar code unless, e.g., `-mavx2` was
+ * given at compile time.
+ */
+enum class SimdLevel { SCALAR, AVX2, AVX512 };
+
+/**
+ * Return the instruction set used by the array functions.
+ *
+ * On first use, the library detects the most capable instruction set that
+ * is both supported by the CPU and compiled into the library, and caches
+ * that choice.
+ */
+SimdLevel simd_level();
+
+/**
+ * Restrict the array functions to max_level or lower.
+ *
+ * Selects the most capable instruction set not exceeding max_level that is
+ * available, and returns it.  This is mostly useful for benchmarking and
+ * testing, since all levels give bit-identical results.
+ *
+ * The level also selects the variant of the mathematical functions: from
+ * AVX2 upwards, the variant compiled with FMA is used.  Unless the library
+ * is built with FMA (XPREC_USE_FMA), this variant may differ in the last
+ * bits.
+ */
+SimdLevel set_simd_level(SimdLevel max_level);
+
+/**
+ * Elementwise sum: out[i] = x[i] + y[i].
+ *
+ * The computation is vectorized if possible (see simd_level()), but the
+ * results are always bit-for-bit identical to the scalar DDouble operators.
+ * This holds for all array functions in this header, also in builds without
+ * FMA (XPREC_USE_FMA=0), where the AVX2 and AVX-512 kernels use Dekker's
+ * product like the scalar operators.  The output may alias any of the
+ * inputs.
+ */
+void add(ConstDDoubleSpan x, ConstDDoubleSpan y, DDoubleSpan out);
+
+/** Elementwise difference: out[i] = x[i] - y[i]. */
+void sub(ConstDDoubleSpan x, ConstDDoubleSpan y, DDoubleSpan out);
+
+/** Elementwise product: out[i] = x[i] * y[i]. */
+void mul(ConstDDoubleSpan x, ConstDDoubleSpan y, DDoubleSpan out);
+
+/**
+ * Elementwise quotient: out[i] = x[i] / y[i].
+ *
+ * Divisions are pipelined across SIMD lanes.  The relative error is bounded
+ * by 10u² (6u² observed), as for the scalar operator.
+ */
+void div(ConstDDoubleSpan x, ConstDDoubleSpan y, DDoubleSpan out);
+
+/**
+ * Divide array by a number: out[i] = x[i] / y.
+ *
+ * Only a single division is needed, since the reciprocal of y is computed
+ * once and used for all elements.
+ */
+void div(ConstDDoubleSpan x, DDouble y, DDoubleSpan out);
+
+/**
+ * Elementwise reciprocal: out[i] = 1 / x[i].
+ *
+ * Divisions are pipelined across SIMD lanes.  The relative error is bounded
+ * by 2u², as for the scalar function.
+ */
+void reciprocal(ConstDDoubleSpan x, DDoubleSpan out);
+
+/** Maximum number of values sharing one division in reciprocal_batch() */
+constexpr size_t RECIPROCAL_BATCH_SEGMENT = 8;
+
+/**
+ * Elementwise reciprocal using Montgomery's simultaneous inversion.
+ *
+ * Computes out[i] = 1 / x[i] using a single reciprocal and 3(m - 1)
+ * multiplications for each segment of m = RECIPROCAL_BATCH_SEGMENT values.
+ * This avoids most divisions at the expense of accuracy: the relative error
+ * is bounded by (8 (m - 1) + 2) u² = 58u², rather than 2u².  Unlike
+ * the other array functions, the results are thus NOT bit-identical to the
+ * scalar reciprocal.
+ *
+ * Zero and non-finite values give the IEEE results (inf for zero, zero for
+ * inf, NaN for NaN).  Values close to overflow or underflow are inverted
+ * one-by-one.  The output may alias the input.
+ */
+void reciprocal_batch(ConstDDoubleSpan x, DDoubleSpan out);
+
+/** Scale array: out[i] = a * x[i]. */
+void mul(DDouble a, ConstDDoubleSpan x, DDoubleSpan out);
+
+/** Scaled update: y[i] = a * x[i] + y[i]. */
+void axpy(DDouble a, ConstDDoubleSpan x, DDoubleSpan y);
+
+} /* namespace xprec */
@@ -0,0 +1,202 @@
+/* Small double-double arithmetic library - linear algebra kernels
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstddef>
+
+#include "array.hpp"
+#include "ddouble.hpp"
+
+namespace xprec {
+
+// ----------------------------------------------------------------------------
+// Level 1: vector operations
+//
+// Vectors are given either as arrays of DDouble, where the i-th element is
+// x[i * incx], or as spans in structure-of-arrays layout (see array.hpp).
+// Only positive increments are supported.  The kernels are vectorized for
+// the CPU (see simd_level()).
+
+/**
+ * Dot product: sum of x[i] * y[i].
+ *
+ * The sum is split across SIMD lanes and several independent chains, each
+ * of which is only normalized every few terms.  This makes it several times
+ * faster than a loop over DDouble operators, which would incur a chain of
+ * dependent 20-flop additions.  The error is bounded by about
+ * (160 + n/2) u² * sum |x[i] y[i]| (compared to 7n u² for said loop), but
+ * the result may differ in the last bits between SIMD levels.
+ */
+DDouble dot(size_t n, const DDouble *x, size_t incx, const DDouble *y,
+            size_t incy);
+
+DDouble dot(ConstDDoubleSpan x, ConstDDoubleSpan y);
+
+/**
+ * Accurate dot product of double vectors: sum of x[i] * y[i].
+ *
+ * Uses the error-free product of ExDouble and sums the results as in the
+ * Dot2 algorithm of Ogita, Rump and Oishi, with the lazy accumulators of
+ * dot().  Costs about 11 flops per term, which is much less than converting
+ * to DDouble first.  The error is bounded by about (160 + n/2) u² times
+ * sum |x[i] y[i]|, so the result is accurate to double-double precision
+ * unless there is severe cancellation.
+ */
+DDouble dot2(const double *x, const double *y, size_t n);
+
+/**
+ * Sum of elements: sum of x[i].
+ *
+ * Accumulated in the same way as dot(): each SIMD lane keeps several
+ * independent partial sums, which only carry the rounding errors in a
+ * double and are normalized every few terms and when they are merged.  This
+ * avoids the serial chain of 20-flop additions of a loop over operator+=.
+ * The error is bounded by about (160 + n/2) u² * sum |x[i]|.
+ */
+DDouble sum(size_t n, const DDouble *x, size_t incx);
+
+DDouble sum(ConstDDoubleSpan x);
+
+/**
+ * Compensated sum of a double array: sum of x[i].
+ *
+ * As sum() for DDouble, but the rounding errors of the double additions are
+ * retained (as in Sum2 of Ogita, Rump and Oishi) at a cost of about 8 flops
+ * per term.  The error bound is the same as above.
+ */
+DDouble sum(const double *x, size_t n);
+
+/**
+ * Reproducible sum of elements: sum of x[i].
+ *
+ * The result is bit-for-bit identical irrespective of the order of the
+ * elements, the SIMD level (see simd_level()) and the number of threads
+ * (see set_gemm_threads()).  To this end, the terms are split into slices
+ * aligned to a fixed set of exponents, derived from the largest term and n,
+ * and the slices are summed without rounding error (binned summation, see
+ * Demmel and Nguyen, IEEE Trans. Comput. 64, 2060 (2015)).  This takes two
+ * passes over the data, and costs about twice as much as sum().
+ *
+ * The error is bounded by about n u² max |x[i]| + 3u² |sum x[i]|.  If any
+ * element is infinite or NaN, so is the result.
+ */
+DDouble reproducible_sum(ConstDDoubleSpan x);
+
+DDouble reproducible_sum(const double *x, size_t n);
+
+/**
+ * Reproducible dot product: sum of x[i] * y[i].
+ *
+ * The result does not depend on the order of the terms, the SIMD level or
+ * the number of threads (see reproducible_sum()).  Since the products are
+ * truncated as in dot(), the error is bounded by about n u² max |x[i] y[i]|
+ * + 2u² sum |x[i] y[i]| for DDouble, and as for reproducible_sum() for
+ * double vectors.
+ *
+ * In builds without FMA (XPREC_USE_FMA=0), products close to underflow may
+ * differ between the scalar and SIMD kernels, since Dekker's product is not
+ * exact there.
+ */
+DDouble reproducible_dot(ConstDDoubleSpan x, ConstDDoubleSpan y);
+
+DDouble reproducible_dot(const double *x, const double *y, size_t n);
+
+/**
+ * Sum of magnitudes: sum of |x[i]|.
+ *
+ * Accumulated in the same way as dot(), so the relative error is bounded by
+ * about (160 + n/2) u².
+ */
+DDouble asum(size_t n, const DDouble *x, size_t incx);
+
+DDouble asum(ConstDDoubleSpan x);
+
+/**
+ * Euclidean norm: square root of the sum of x[i]^2.
+ *
+ * The sum of squares is accumulated as in dot().  If it overflows or gets
+ * close to underflow, the vector is scaled by a power of two, as in hypot(),
+ * and summed again.  The relative error is bounded by about (80 + n/4) u².
+ */
+DDouble nrm2(size_t n, const DDouble *x, size_t incx);
+
+DDouble nrm2(ConstDDoubleSpan x);
+
+/**
+ * Return index of the first element with the largest magnitude.
+ *
+ * Returns zero if n is zero.  Unlike in BLAS, indices start at zero.
+ */
+size_t iamax(size_t n, const DDouble *x, size_t incx);
+
+size_t iamax(ConstDDoubleSpan x);
+
+/**
+ * Scaled update: y[i] = a * x[i] + y[i].
+ *
+ * Gives the same result as the DDouble operators.  For spans, use axpy()
+ * from array.hpp.
+ */
+void axpy(size_t n, DDouble a, const DDouble *x, size_t incx, DDouble *y,
+          size_t incy);
+
+/** Scale vector: x[i] = a * x[i], with the same result as the operators */
+void scal(size_t n, DDouble a, DDouble *x, size_t incx);
+
+void scal(DDouble a, DDoubleSpan x);
+
+// ----------------------------------------------------------------------------
+// Level 3: matrix-matrix operations
+
+/** Whether a matrix argument is to be used as is or transposed */
+enum class Transpose { NO, YES };
+
+/**
+ * General matrix-matrix product: C = alpha * op(A) * op(B) + beta * C.
+ *
+ * All matrices are stored in column-major order as arrays of DDouble with
+ * leading dimensions lda, ldb, ldc, following the conventions of BLAS:
+ * op(A) is m x k, op(B) is k x n, and C is m x n, where op(X) is either X
+ * or its transpose, depending on transa and transb.  C must not overlap
+ * A or B.
+ *
+ * The result is computed as if by the loop:
+ *
+ *     C[i,j] = beta * C[i,j];
+ *     for (size_t p = 0; p != k; ++p)
+ *         C[i,j] += (alpha * op(A)[i,p]) * op(B)[p,j];
+ *
+ * where the multiplications by alpha and beta are skipped if they are one.
+ * If beta is zero, C need not be initialized.  The results are bit-for-bit
+ * identical to this loop, irrespective of the number of threads and the
+ * SIMD level (but see add() in array.hpp for builds without FMA).  Thus,
+ * the error is bounded by roughly (k + 1) * 7u² * sum_p |A[i,p] B[p,j]|.
+ *
+ * Internally, blocks of A and B are packed into separate hi and lo arrays,
+ * which are fed to register-blocked micro-kernels vectorized for the CPU
+ * (see simd_level()).  Large products are split into tiles of C, which are
+ * distributed over gemm_threads() threads.
+ */
+void gemm(Transpose transa, Transpose transb, size_t m, size_t n, size_t k,
+          DDouble alpha, const DDouble *a, size_t lda, const DDouble *b,
+          size_t ldb, DDouble beta, DDouble *c, size_t ldc);
+
+/**
+ * Return the maximum number of threads used by gemm() and the reproducible
+ * reductions.
+ */
+unsigned gemm_threads();
+
+/**
+ * Set the maximum number of threads used by gemm() and the reproducible
+ * reductions, and return it.
+ *
+ * Passing zero selects the number of concurrent threads supported by the
+ * hardware, which is also the default.  Small products and sums are always
+ * computed in the calling thread.
+ */
+unsigned set_gemm_threads(unsigned max_threads);
+
+} /* namespace xprec */
@@ -5,6 +5,26 @@
  */
 #pragma once
 #include "version.h"
+#include <cmath>
+
+/**
+ * Use fused multiply-add (FMA) for the error-free product?
+ *
+ * FMA makes the exact product of two doubles a matter of two flops.  If the
+ * target lacks FMA in hardware, however, std::fma is emulated in software,
+ * which is dramatically slower.  In this case we instead use Dekker's product
+ * with Veltkamp splitting, which only requires plain arithmetic.
+ *
+ * By default, FMA is used if the compiler targets a CPU with hardware FMA.
+ * Define XPREC_USE_FMA to 0 or 1 to force either path.
+ */
+#ifndef XPREC_USE_FMA
+#if defined(__FMA__) || defined(__ARM_FEATURE_FMA) || defined(FP_FAST_FMA)
+#define XPREC_USE_FMA 1
+#else
+#define XPREC_USE_FMA 0
+#endif
+#endif
 
 namespace xprec {
 
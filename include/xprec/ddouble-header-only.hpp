@@ -16,6 +16,8 @@
 // directly.
 #define XPREC_API_EXPORT inline
 
+#include "../../src/array.cpp"
+#include "../../src/blas.cpp"
 #include "../../src/circular.cpp"
 #include "../../src/exp.cpp"
 #include "../../src/floats.cpp"
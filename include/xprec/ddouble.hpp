@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: MIT
  */
 #pragma once
+#include <cfloat>
 #include <cmath>
 #include <cstdint>
 #include <iosfwd>
@@ -29,16 +30,23 @@ namespace xprec {
  *   | add_small  |    3 flops |   2u² |    17 flops |   3u² |
  *   | + -        |   10 flops |   2u² |    20 flops |   3u² |
  *   | *          |    6 flops |   2u² |     9 flops |   4u² |
- *   | /          |   10 flops |   3u² |    28 flops |   6u² |
- *   | reciprocal |   14 flops | 2.3u² |    19 flops | 2.3u² |
+ *   | /          |   10 flops |   3u² |    32 flops |   4u² |
+ *   | reciprocal |   14 flops | 2.3u² |    23 flops |   1u² |
  *
- * The error bounds are tight analytical bounds [^2][^3], except in the case of
- * double-double division, where the bound is 10u² but largest observed error
- * is 6u². We report the largest observed error here [^1].
+ * The error bounds are tight analytical bounds [^1][^2], except in the case of
+ * double-double division and reciprocal [^3], where the bounds are 6u² and
+ * 2u², but the largest observed errors are 4u² and 1u². We report the largest
+ * observed errors here.
+ *
+ * These numbers assume hardware fused multiply-add (FMA).  Without it (see
+ * XPREC_USE_FMA), products use Dekker's algorithm: multiplication by double
+ * then costs 22 flops with an error of 3u², and multiplication by DDouble
+ * costs 24 flops with an error of 7u².
  *
  * [^1]: M. Joldes, et al., ACM Trans. Math. Softw. 44, 1-27 (2018)
  * [^2]: J.-M. Muller and L. Rideau, ACM Trans. Math. Softw. 48, 1, 9 (2022)
- * [^3]: The flop count has been reduced by 3 for divisons/reciprocals
+ * [^3]: Modified from [^1] to include the second-order term of the
+ *       reciprocal, see arith.hpp
  */
 class DDouble {
 public:
@@ -113,6 +121,35 @@ public:
 
     friend DDouble reciprocal(DDouble y);
 
+    /**
+     * Fused multiply-add: compute a * b + c.
+     *
+     * The product is truncated as in operator*, but not normalized before c
+     * is added, which saves 3 flops over a * b + c (e.g., 26 instead of 29
+     * flops for DDouble arguments).  The lo part of the product then only
+     * satisfies |lo| <= 3u |hi| (2u |hi| if b is double) instead of u |hi|.
+     * The error-free steps of the addition remain exact under this
+     * condition, so adapting the proofs of Joldes et al., the error is
+     * bounded by:
+     *
+     *   | a, b             | c double             | c DDouble             |
+     *   |------------------|---------------------:|----------------------:|
+     *   | DDouble, DDouble | 7u² |ab| + u² |ab+c| | 8u² |ab| + 3u² |ab+c| |
+     *   | DDouble, double  | 4u² |ab| + u² |ab+c| | 5u² |ab| + 3u² |ab+c| |
+     *
+     * up to terms of order u³.  Without FMA (see XPREC_USE_FMA), the product
+     * is less accurate, which adds 3u² |ab| and 1u² |ab|, respectively.  If
+     * a and b are double, the product is exact and normalized, and the error
+     * is that of the addition alone.
+     */
+    friend DDouble fma(DDouble a, DDouble b, DDouble c);
+    friend DDouble fma(DDouble a, DDouble b, double c);
+    friend DDouble fma(DDouble a, double b, DDouble c);
+    friend DDouble fma(DDouble a, double b, double c);
+    friend DDouble fma(double a, DDouble b, DDouble c) { return fma(b, a, c); }
+    friend DDouble fma(double a, DDouble b, double c) { return fma(b, a, c); }
+    friend DDouble fma(double a, double b, DDouble c);
+
     DDouble &operator+=(double y) { return *this = *this + y; }
     DDouble &operator-=(double y) { return *this = *this - y; }
     DDouble &operator*=(double y) { return *this = *this * y; }
@@ -189,6 +226,8 @@ public:
     friend DDouble operator/(ExDouble a, ExDouble b);
 
     friend DDouble reciprocal(ExDouble y);
+
+    /** Exact product a * b plus c, rounded to DDouble (12 flops, error 2 u²) */
     friend DDouble fma(ExDouble a, ExDouble b, ExDouble c);
 
 private:
@@ -299,6 +338,22 @@ void gauss_legendre(int n, DDouble x[], DDouble w[] = nullptr);
 /** Trigonometric complement sqrt(1 - x*x) to full precision. */
 DDouble trig_complement(DDouble x);
 
+/**
+ * Compute sine and cosine of x at the same time.
+ *
+ * The argument is reduced only once, and both Taylor series share the
+ * powers of x, which costs about half as much as calling sin() and cos().
+ */
+void sincos(DDouble x, DDouble &s, DDouble &c);
+
+/**
+ * Compute hyperbolic sine and cosine of x at the same time.
+ *
+ * Both are computed from a single expm1() and reciprocal, which costs about
+ * half as much as calling sinh() and cosh().
+ */
+void sinhcosh(DDouble x, DDouble &s, DDouble &c);
+
 } /* namespace xprec*/
 
 namespace std {
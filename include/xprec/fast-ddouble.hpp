@@ -0,0 +1,202 @@
+/* Small double-double arithmetic library - sloppy arithmetic
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cmath>
+
+#include "ddouble.hpp"
+
+namespace xprec {
+
+/**
+ * Double-double number with cheaper, less accurate arithmetic.
+ *
+ * Stores the same pair of doubles as DDouble, but the operators use the
+ * "sloppy" variants of the algorithms in Joldes et al. [^1], which skip some
+ * of the corrections.  The rough cost in flops and the largest relative
+ * error as multiples of u² compare to DDouble as follows:
+ *
+ *   | (op)       | (op)FastDDouble | error | (op)DDouble | error |
+ *   |------------|----------------:|------:|------------:|------:|
+ *   | + -        |        11 flops |  3u²* |    20 flops |   3u² |
+ *   | *          |         8 flops |   5u² |     9 flops |   4u² |
+ *   | /          |       14* flops |   8u² |   32* flops |   4u² |
+ *   | reciprocal |       13* flops |   4u² |   23* flops |   1u² |
+ *
+ * Operations with double are the same as for DDouble.  An asterisk after
+ * the flop count indicates two double divisions instead of one.  Addition
+ * uses Algorithm 5, which does not add the lo parts exactly.  For terms of
+ * the same sign, this is harmless, but for terms of opposite sign the error
+ * is only bounded by about 3u² (|x| + |y|) rather than 3u² |x + y|, so the
+ * relative error is unbounded under cancellation.  Multiplication drops the
+ * product of the lo parts (Algorithm 11).  Division corrects the quotient of
+ * the hi parts only once, as in Algorithm 15, rather than multiplying by the
+ * reciprocal.  Without FMA, multiplication is the same as for DDouble.  The
+ * error bounds for division and reciprocal are the largest observed errors.
+ *
+ * This gives roughly 100 bits of precision where the guarantees of DDouble
+ * are not needed.  FastDDouble converts explicitly to and from DDouble,
+ * which has to be used for the mathematical functions.
+ *
+ * [^1]: M. Joldes, et al., ACM Trans. Math. Softw. 44, 1-27 (2018)
+ */
+class FastDDouble {
+public:
+    constexpr FastDDouble(double x) : _hi(x), _lo(0.0) { }
+
+    // Ensure that trivially_*_constructible work.
+    FastDDouble() = default;
+
+    /** Convert from DDouble */
+    constexpr explicit FastDDouble(DDouble x) : _hi(x.hi()), _lo(x.lo()) { }
+
+    /**
+     * Construct FastDDouble from hi and low part.
+     *
+     * WARNING: You MUST ensure that abs(hi) > epsilon * abs(lo).
+     */
+    constexpr FastDDouble(double hi, double lo) : _hi(hi), _lo(lo) { }
+
+    /** Convert to DDouble */
+    constexpr explicit operator DDouble() const { return DDouble(_hi, _lo); }
+
+    constexpr explicit operator double() const { return _hi; }
+
+    /** Get high part */
+    constexpr double hi() const { return _hi; }
+
+    /** Get low part */
+    constexpr double lo() const { return _lo; }
+
+    friend FastDDouble operator+(FastDDouble x, double y)
+    {
+        return FastDDouble(DDouble(x) + y);
+    }
+
+    friend FastDDouble operator+(FastDDouble x, FastDDouble y)
+    {
+        // Algorithm 5: cost 11 flops, error 3 u^2 if x and y have same sign
+        DDouble s = ExDouble(x._hi) + y._hi;
+        double v = x._lo + y._lo;
+        double w = s.lo() + v;
+        return FastDDouble(ExDouble(s.hi()).add_small(w));
+    }
+
+    friend FastDDouble operator+(double x, FastDDouble y) { return y + x; }
+
+    friend FastDDouble operator-(FastDDouble x, double y) { return x + (-y); }
+    friend FastDDouble operator-(double x, FastDDouble y) { return x + (-y); }
+    friend FastDDouble operator-(FastDDouble x, FastDDouble y)
+    {
+        return x + (-y);
+    }
+
+    friend FastDDouble operator+(FastDDouble x) { return x; }
+    friend FastDDouble operator-(FastDDouble x)
+    {
+        return FastDDouble(-x._hi, -x._lo);
+    }
+
+    friend FastDDouble operator*(FastDDouble x, double y)
+    {
+        return FastDDouble(DDouble(x) * y);
+    }
+
+    friend FastDDouble operator*(FastDDouble x, FastDDouble y)
+    {
+#if XPREC_USE_FMA
+        // Algorithm 11: cost 8 flops, error 5 u^2
+        DDouble c = ExDouble(x._hi) * y._hi;
+        double tl = x._lo * y._hi;
+        double cl2 = std::fma(x._hi, y._lo, tl);
+        double cl3 = c.lo() + cl2;
+        return FastDDouble(ExDouble(c.hi()).add_small(cl3));
+#else
+        return FastDDouble(DDouble(x) * DDouble(y));
+#endif
+    }
+
+    friend FastDDouble operator*(double x, FastDDouble y) { return y * x; }
+
+    friend FastDDouble operator/(FastDDouble x, double y)
+    {
+        return FastDDouble(DDouble(x) / y);
+    }
+
+    friend FastDDouble operator/(FastDDouble x, FastDDouble y)
+    {
+        // Algorithm 15 with the product of Algorithm 9: cost 14 flops.
+        // Since th * y.hi is within a factor of two of x.hi, the first
+        // subtraction is exact.
+        ExDouble th = x._hi / y._hi;
+        DDouble pi = DDouble(y) * (double)th;
+        double delta_h = x._hi - pi.hi();
+        double delta_tee = delta_h - pi.lo();
+        double delta = delta_tee + x._lo;
+        double tl = delta / y._hi;
+        return FastDDouble(th.add_small(tl));
+    }
+
+    friend FastDDouble operator/(double x, FastDDouble y)
+    {
+        return FastDDouble(x) / y;
+    }
+
+    friend FastDDouble reciprocal(FastDDouble y)
+    {
+        // As division, with x = 1: cost 13 flops
+        ExDouble th = 1.0 / y._hi;
+        DDouble pi = DDouble(y) * (double)th;
+        double delta = (1.0 - pi.hi()) - pi.lo();
+        double tl = delta / y._hi;
+        return FastDDouble(th.add_small(tl));
+    }
+
+    FastDDouble &operator+=(double y) { return *this = *this + y; }
+    FastDDouble &operator-=(double y) { return *this = *this - y; }
+    FastDDouble &operator*=(double y) { return *this = *this * y; }
+    FastDDouble &operator/=(double y) { return *this = *this / y; }
+
+    FastDDouble &operator+=(FastDDouble y) { return *this = *this + y; }
+    FastDDouble &operator-=(FastDDouble y) { return *this = *this - y; }
+    FastDDouble &operator*=(FastDDouble y) { return *this = *this * y; }
+    FastDDouble &operator/=(FastDDouble y) { return *this = *this / y; }
+
+    friend bool operator==(FastDDouble x, FastDDouble y)
+    {
+        return DDouble(x) == DDouble(y);
+    }
+
+    friend bool operator!=(FastDDouble x, FastDDouble y)
+    {
+        return DDouble(x) != DDouble(y);
+    }
+
+    friend bool operator<(FastDDouble x, FastDDouble y)
+    {
+        return DDouble(x) < DDouble(y);
+    }
+
+    friend bool operator<=(FastDDouble x, FastDDouble y)
+    {
+        return DDouble(x) <= DDouble(y);
+    }
+
+    friend bool operator>(FastDDouble x, FastDDouble y)
+    {
+        return DDouble(x) > DDouble(y);
+    }
+
+    friend bool operator>=(FastDDouble x, FastDDouble y)
+    {
+        return DDouble(x) >= DDouble(y);
+    }
+
+private:
+    double _hi;
+    double _lo;
+};
+
+} /* namespace xprec */
@@ -0,0 +1,448 @@
+/* Small double-double arithmetic library - float-float arithmetic
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cmath>
+#include <iosfwd>
+#include <limits>
+
+#include "ddouble.hpp"
+
+namespace xprec {
+
+class FFloat;
+
+namespace _ffloat {
+
+inline FFloat add_small(float a, float b);
+inline FFloat add_small(float a, FFloat b);
+inline FFloat two_sum(float a, float b);
+inline FFloat two_prod(float a, float b);
+inline float exact_remainder(float a, float b, float c);
+inline FFloat from_double(double hi, double lo);
+
+} /* namespace _ffloat */
+
+/**
+ * Class for float-float arithmetic.
+ *
+ * Pair of floats with the same algorithms as DDouble (see there), giving
+ * about 48 significant bits.  This is sufficient for preconditioners and
+ * mixed-precision inner stages, and a float-float takes half the memory and
+ * bandwidth of a DDouble.  Only the scalar type is provided: there are no
+ * array, SIMD or Eigen packet kernels for FFloat, so loops over FFloat are
+ * not vectorized by this library.  The flop counts are the same as for
+ * DDouble, and the errors are the same multiples of u² = 3.55e-15 (half the
+ * machine epsilon of float, squared).  Without FMA (see XPREC_USE_FMA), the exact product of two
+ * floats is computed in double precision rather than with Dekker's product,
+ * which is much cheaper: products then cost only two flops more than with
+ * FMA, with the errors given for DDouble without FMA.
+ *
+ * The range is the one of float, with precision lost below about 1e-31,
+ * where the lo part becomes denormal.  The mathematical functions other than
+ * sqrt() are evaluated by converting to DDouble, which is exact, and
+ * rounding back, so they are accurate but not faster than for DDouble.
+ */
+class FFloat {
+public:
+    constexpr FFloat(float x) : _hi(x), _lo(0.0f) { }
+
+    // Ensure that trivially_*_constructible work.
+    FFloat() = default;
+
+    /**
+     * Construct FFloat from hi and low part.
+     *
+     * WARNING: You MUST ensure that abs(hi) > epsilon * abs(lo).
+     */
+    constexpr FFloat(float hi, float lo) : _hi(hi), _lo(lo) { }
+
+    /** Round double to FFloat */
+    explicit FFloat(double x) : FFloat(_ffloat::from_double(x, 0.0)) { }
+
+    /** Round DDouble to FFloat */
+    explicit FFloat(DDouble x) : FFloat(_ffloat::from_double(x.hi(), x.lo()))
+    { }
+
+    /** Convert exactly to DDouble */
+    explicit operator DDouble() const { return ExDouble(_hi).add_small(_lo); }
+
+    /** Convert FFloat to different type */
+    template <typename T>
+    constexpr T as() const
+    {
+        return static_cast<T>(_hi) + static_cast<T>(_lo);
+    }
+
+    constexpr explicit operator float() const { return _hi; }
+
+    /** Get high part of a float-float */
+    constexpr float hi() const { return _hi; }
+
+    /** Get low part of a float-float */
+    constexpr float lo() const { return _lo; }
+
+    friend FFloat operator+(FFloat x, float y)
+    {
+        // Algorithm 4: cost 10 flops, error 2 u^2
+        FFloat s = _ffloat::two_sum(x._hi, y);
+        float v = x._lo + s._lo;
+        return _ffloat::add_small(s._hi, v);
+    }
+
+    friend FFloat operator+(FFloat x, FFloat y)
+    {
+        // Algorithm 6: cost 20 flops, error 3 u^2 + 13 u^3
+        FFloat s = _ffloat::two_sum(x._hi, y._hi);
+        FFloat t = _ffloat::two_sum(x._lo, y._lo);
+        float c = s._lo + t._hi;
+        FFloat v = _ffloat::add_small(s._hi, c);
+        float w = t._lo + v._lo;
+        return _ffloat::add_small(v._hi, w);
+    }
+
+    friend FFloat operator+(float x, FFloat y) { return y + x; }
+
+    friend FFloat operator-(FFloat x, float y) { return x + (-y); }
+    friend FFloat operator-(float x, FFloat y) { return x + (-y); }
+    friend FFloat operator-(FFloat x, FFloat y) { return x + (-y); }
+
+    friend FFloat operator+(FFloat x) { return x; }
+    friend FFloat operator-(FFloat x) { return FFloat(-x._hi, -x._lo); }
+
+    friend FFloat operator*(FFloat x, float y)
+    {
+        FFloat c = _ffloat::two_prod(x._hi, y);
+#if XPREC_USE_FMA
+        // Algorithm 9: cost 6 flops, error 2 u^2
+        float cl3 = std::fma(x._lo, y, c._lo);
+#else
+        // Algorithm 8: cost 8 flops, error 3 u^2
+        float cl3 = c._lo + x._lo * y;
+#endif
+        return _ffloat::add_small(c._hi, cl3);
+    }
+
+    friend FFloat operator*(FFloat x, FFloat y)
+    {
+        FFloat c = _ffloat::two_prod(x._hi, y._hi);
+#if XPREC_USE_FMA
+        // Algorithm 12: cost 9 flops, error 4 u^2 (corrected)
+        float tl0 = x._lo * y._lo;
+        float tl1 = std::fma(x._hi, y._lo, tl0);
+        float cl2 = std::fma(x._lo, y._hi, tl1);
+#else
+        // Algorithm 10: cost 10 flops, error 7 u^2
+        float cl2 = x._hi * y._lo + x._lo * y._hi;
+#endif
+        float cl3 = c._lo + cl2;
+        return _ffloat::add_small(c._hi, cl3);
+    }
+
+    friend FFloat operator*(float x, FFloat y) { return y * x; }
+
+    friend FFloat operator/(FFloat x, float y)
+    {
+        // Algorithm 15: cost 10 flops, error 3 u^2
+        float th = x._hi / y;
+        FFloat pi = _ffloat::two_prod(th, y);
+        float delta_h = x._hi - pi._hi;
+        float delta_tee = delta_h - pi._lo;
+        float delta = delta_tee + x._lo;
+        float tl = delta / y;
+        return _ffloat::add_small(th, tl);
+    }
+
+    friend FFloat reciprocal(FFloat y)
+    {
+        // Part of Algorithm 18: cost 23 flops, error 2 u^2 (1 u^2 obs.)
+        // As for DDouble, rh may be smaller than rl, and the second-order
+        // term e^2 of 1/y = th (1 + e + e^2 + ...) is added to e.
+        float th = 1.0f / y._hi;
+        float rh = _ffloat::exact_remainder(y._hi, th, 1.0f);
+        float rl = -y._lo * th;
+        FFloat e = _ffloat::two_sum(rh, rl);
+#if XPREC_USE_FMA
+        float el = std::fma(e._hi, e._hi, e._lo);
+#else
+        float el = e._lo + e._hi * e._hi;
+#endif
+        FFloat delta = FFloat(e._hi, el) * th;
+        return _ffloat::add_small(th, delta);
+    }
+
+    friend FFloat operator/(FFloat x, FFloat y)
+    {
+        // Algorithm 18: cost 32 flops, error 6 u^2 (4 u^2 obs.)
+        return x * reciprocal(y);
+    }
+
+    friend FFloat operator/(float x, FFloat y) { return x * reciprocal(y); }
+
+    friend FFloat sqrt(FFloat a)
+    {
+        // Karp's method (see sqrt for DDouble): cost 7 flops
+        float y0 = std::sqrt(a._hi);
+        if (a._hi <= 0.0f || !std::isfinite(a._hi))
+            return y0;
+
+        float x0_half = 0.5f / y0;
+        float r0 = _ffloat::exact_remainder(y0, y0, a._hi);
+        float delta_y = x0_half * (r0 + a._lo);
+        return _ffloat::add_small(y0, delta_y);
+    }
+
+    FFloat &operator+=(float y) { return *this = *this + y; }
+    FFloat &operator-=(float y) { return *this = *this - y; }
+    FFloat &operator*=(float y) { return *this = *this * y; }
+    FFloat &operator/=(float y) { return *this = *this / y; }
+
+    FFloat &operator+=(FFloat y) { return *this = *this + y; }
+    FFloat &operator-=(FFloat y) { return *this = *this - y; }
+    FFloat &operator*=(FFloat y) { return *this = *this * y; }
+    FFloat &operator/=(FFloat y) { return *this = *this / y; }
+
+    friend bool operator==(FFloat x, FFloat y)
+    {
+        return x._hi == y._hi && x._lo == y._lo;
+    }
+
+    friend bool operator!=(FFloat x, FFloat y)
+    {
+        return x._hi != y._hi || x._lo != y._lo;
+    }
+
+    friend bool operator<=(FFloat x, FFloat y)
+    {
+        return x._hi < y._hi || (x._hi == y._hi && x._lo <= y._lo);
+    }
+
+    friend bool operator<(FFloat x, FFloat y)
+    {
+        return x._hi < y._hi || (x._hi == y._hi && x._lo < y._lo);
+    }
+
+    friend bool operator>=(FFloat x, FFloat y)
+    {
+        return x._hi > y._hi || (x._hi == y._hi && x._lo >= y._lo);
+    }
+
+    friend bool operator>(FFloat x, FFloat y)
+    {
+        return x._hi > y._hi || (x._hi == y._hi && x._lo > y._lo);
+    }
+
+private:
+    float _hi;
+    float _lo;
+};
+
+namespace _ffloat {
+
+inline FFloat add_small(float a, float b)
+{
+    // Algorithm 1: cost 3 flops
+    float s = a + b;
+    float z = s - a;
+    float t = b - z;
+    return FFloat(s, t);
+}
+
+inline FFloat add_small(float a, FFloat b)
+{
+    // Algorithm 4 modified: cost 7 flops, error 2 u^2
+    FFloat s = add_small(a, b.hi());
+    float v = b.lo() + s.lo();
+    return add_small(s.hi(), v);
+}
+
+inline FFloat two_sum(float a, float b)
+{
+    // Algorithm 2: cost 6 flops
+    float s = a + b;
+    float aprime = s - b;
+    float bprime = s - aprime;
+    float delta_a = a - aprime;
+    float delta_b = b - bprime;
+    float t = delta_a + delta_b;
+    return FFloat(s, t);
+}
+
+inline FFloat two_prod(float a, float b)
+{
+#if XPREC_USE_FMA
+    // Algorithm 3: cost 2 flops
+    float pi = a * b;
+    float rho = std::fma(a, b, -pi);
+#else
+    // The product of two floats is exact in double precision: cost 3 flops
+    double p = (double)a * b;
+    float pi = (float)p;
+    float rho = (float)(p - pi);
+#endif
+    return FFloat(pi, rho);
+}
+
+/** Return c - a * b, where the result must be representable as float */
+inline float exact_remainder(float a, float b, float c)
+{
+#if XPREC_USE_FMA
+    return std::fma(-a, b, c);
+#else
+    return (float)(c - (double)a * b);
+#endif
+}
+
+/** Round the sum of hi and lo to float-float, where |hi| >= |lo| */
+inline FFloat from_double(double hi, double lo)
+{
+    float h = (float)hi;
+    if (!std::isfinite(h))
+        return h;
+
+    // hi - h is exact, since h is the closest float to hi
+    float l = (float)((hi - h) + lo);
+    return add_small(h, l);
+}
+
+} /* namespace _ffloat */
+
+inline FFloat abs(FFloat x) { return x.hi() < 0 ? -x : x; }
+inline FFloat fabs(FFloat x) { return abs(x); }
+
+inline FFloat ldexp(FFloat x, int m)
+{
+    return FFloat(std::ldexp(x.hi(), m), std::ldexp(x.lo(), m));
+}
+
+inline bool isfinite(FFloat x) { return std::isfinite(x.hi()); }
+inline bool isinf(FFloat x) { return std::isinf(x.hi()); }
+inline bool isnan(FFloat x) { return std::isnan(x.hi()); }
+
+// The remaining functions are computed in double-double precision.
+inline FFloat exp(FFloat x) { return FFloat(exp(DDouble(x))); }
+inline FFloat expm1(FFloat x) { return FFloat(expm1(DDouble(x))); }
+inline FFloat log(FFloat x) { return FFloat(log(DDouble(x))); }
+inline FFloat log1p(FFloat x) { return FFloat(log1p(DDouble(x))); }
+inline FFloat pow(FFloat x, FFloat y)
+{
+    return FFloat(pow(DDouble(x), DDouble(y)));
+}
+inline FFloat sin(FFloat x) { return FFloat(sin(DDouble(x))); }
+inline FFloat cos(FFloat x) { return FFloat(cos(DDouble(x))); }
+inline FFloat tan(FFloat x) { return FFloat(tan(DDouble(x))); }
+inline FFloat asin(FFloat x) { return FFloat(asin(DDouble(x))); }
+inline FFloat acos(FFloat x) { return FFloat(acos(DDouble(x))); }
+inline FFloat atan(FFloat x) { return FFloat(atan(DDouble(x))); }
+inline FFloat atan2(FFloat y, FFloat x)
+{
+    return FFloat(atan2(DDouble(y), DDouble(x)));
+}
+inline FFloat sinh(FFloat x) { return FFloat(sinh(DDouble(x))); }
+inline FFloat cosh(FFloat x) { return FFloat(cosh(DDouble(x))); }
+inline FFloat tanh(FFloat x) { return FFloat(tanh(DDouble(x))); }
+inline FFloat hypot(FFloat x, FFloat y)
+{
+    return FFloat(hypot(DDouble(x), DDouble(y)));
+}
+
+inline std::ostream &operator<<(std::ostream &out, FFloat x)
+{
+    return out << DDouble(x);
+}
+
+} /* namespace xprec */
+
+namespace std {
+
+/**
+ * Specialization of numerical limits for the float-float type.
+ */
+template <>
+class numeric_limits<xprec::FFloat> {
+    using FFloat = xprec::FFloat;
+    using _float = numeric_limits<float>;
+
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+
+    static constexpr bool has_infinity = _float::has_infinity;
+    static constexpr bool has_quiet_NaN = _float::has_quiet_NaN;
+    static constexpr bool has_signaling_NaN = _float::has_signaling_NaN;
+    static constexpr float_denorm_style has_denorm = _float::has_denorm;
+    static constexpr bool has_denorm_loss = false;
+
+    static constexpr float_round_style round_style = _float::round_style;
+    static constexpr int digits = 2 * _float::digits + 1;
+    static constexpr int digits10 = 2 * _float::digits10;
+    static constexpr int max_digits10 = 2 * _float::max_digits10;
+
+    static constexpr int radix = _float::radix;
+
+    static constexpr int min_exponent = _float::min_exponent + _float::digits;
+    static constexpr int min_exponent10 =
+        _float::min_exponent10 + _float::digits10;
+    static constexpr int max_exponent = _float::max_exponent;
+    static constexpr int max_exponent10 = _float::max_exponent10;
+
+    static constexpr FFloat min() noexcept
+    {
+        return FFloat(_float::min() / _float::epsilon());
+    }
+
+    static constexpr FFloat max() noexcept
+    {
+        return FFloat(_float::max(), _float::max() * _float::epsilon()
+                                        / _float::radix / _float::radix);
+    }
+
+    static constexpr FFloat lowest() noexcept
+    {
+        return FFloat(_float::lowest(), _float::lowest() * _float::epsilon()
+                                            / _float::radix / _float::radix);
+    }
+
+    static constexpr FFloat epsilon() noexcept
+    {
+        return FFloat(_float::epsilon() * _float::epsilon() / _float::radix);
+    }
+
+    static constexpr FFloat round_error() noexcept
+    {
+        return FFloat(_float::round_error());
+    }
+
+    static constexpr FFloat infinity() noexcept
+    {
+        return FFloat(_float::infinity(), _float::infinity());
+    }
+
+    static constexpr FFloat quiet_NaN() noexcept
+    {
+        return FFloat(_float::quiet_NaN(), _float::quiet_NaN());
+    }
+
+    static constexpr FFloat signaling_NaN() noexcept
+    {
+        return FFloat(_float::signaling_NaN(), _float::signaling_NaN());
+    }
+
+    static constexpr FFloat denorm_min() noexcept
+    {
+        return FFloat(_float::denorm_min());
+    }
+
+    static constexpr bool is_bounded = _float::is_bounded;
+    static constexpr bool is_iec559 = false;
+    static constexpr bool is_modulo = false;
+
+    static constexpr bool traps = false;
+    static constexpr bool tinyness_before = false;
+};
+
+} /* namespace std */
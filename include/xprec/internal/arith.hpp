@@ -10,9 +10,37 @@
  */
 #include "../ddouble.hpp"
 #include <cassert>
+#include <utility>
 
 namespace xprec {
 
+// -------------------------------------------------------------------------
+// Classification
+
+namespace _internal {
+
+// The classification functions from <cmath> are inline functions in
+// namespace std, which unoptimized builds emit with external linkage.  Since
+// this header is also compiled for other instruction sets (see
+// src/mathfn.hpp), the linker might then pick, say, the FMA copy of
+// std::isfinite for use in the baseline code.  Functions in namespace xprec
+// are private to each variant, so we use these instead.
+#if defined(__GNUC__)
+inline bool is_finite(double x) { return __builtin_isfinite(x); }
+inline bool is_inf(double x) { return __builtin_isinf(x); }
+inline bool is_nan(double x) { return __builtin_isnan(x); }
+inline bool is_normal(double x) { return __builtin_isnormal(x); }
+inline bool sign_bit(double x) { return __builtin_signbit(x); }
+#else
+inline bool is_finite(double x) { return std::isfinite(x); }
+inline bool is_inf(double x) { return std::isinf(x); }
+inline bool is_nan(double x) { return std::isnan(x); }
+inline bool is_normal(double x) { return std::isnormal(x); }
+inline bool sign_bit(double x) { return std::signbit(x); }
+#endif
+
+} // namespace _internal
+
 // -------------------------------------------------------------------------
 // PowerOfTwo
 
@@ -30,7 +58,7 @@ inline DDouble ExDouble::add_small(double b) const
     double s = _x + b;
     double z = s - _x;
     double t = b - z;
-    assert (s + t == s || !std::isfinite(s));
+    assert (s + t == s || !_internal::is_finite(s));
     return DDouble(s, t);
 }
 
@@ -59,6 +87,8 @@ inline DDouble operator+(ExDouble a, ExDouble b)
 
 inline DDouble operator-(ExDouble a, ExDouble b) { return a + (-b); }
 
+#if XPREC_USE_FMA
+
 inline DDouble operator*(ExDouble a, ExDouble b)
 {
     // Algorithm 3: cost 2 flops
@@ -67,15 +97,81 @@ inline DDouble operator*(ExDouble a, ExDouble b)
     return DDouble(pi, rho);
 }
 
+#else
+
+namespace _internal {
+
+inline void veltkamp_split(double a, double &hi, double &lo)
+{
+    // Veltkamp's splitting: cost 4 flops.  hi gets the upper 26 bits of the
+    // mantissa of a and lo = a - hi the rest (as 26 bits plus a sign), such
+    // that the products of the parts are exact.
+    const double splitter = 134217729.0; // 2^27 + 1
+    double gamma = splitter * a;
+    hi = gamma - (gamma - a);
+    lo = a - hi;
+}
+
+inline double dekker_error(double a, double b, double pi)
+{
+    // Dekker's product: cost 16 flops, returns a * b - pi exactly.
+    double ah, al, bh, bl;
+    veltkamp_split(a, ah, al);
+    veltkamp_split(b, bh, bl);
+    return ((ah * bh - pi) + ah * bl + al * bh) + al * bl;
+}
+
+} // namespace _internal
+
+inline DDouble operator*(ExDouble a, ExDouble b)
+{
+    // Algorithm 3 without FMA: cost 17 flops
+    double pi = (double)a * (double)b;
+    double rho = _internal::dekker_error((double)a, (double)b, pi);
+    if (!_internal::is_finite(rho) && _internal::is_finite(pi)) {
+        // The splitting or one of the partial products overflowed, so we
+        // scale down the larger factor.  This is exact since it is large.
+        const double down = 1.1102230246251565e-16; // 2^-53
+        double big = (double)a, small = (double)b;
+        if (std::fabs(big) < std::fabs(small))
+            std::swap(big, small);
+        rho = _internal::dekker_error(big * down, small, pi * down) / down;
+    }
+    return DDouble(pi, rho);
+}
+
+#endif
+
+namespace _internal {
+
+/**
+ * Return c - a * b, where the result must be representable as double.
+ *
+ * This is the case for the remainder of division and square root, i.e.,
+ * when b = RN(c/a) or a = b = RN(sqrt(c)).  Without FMA, this requires that
+ * a * b is within a factor of two of c, such that the subtraction is exact.
+ */
+inline double exact_remainder(double a, double b, double c)
+{
+#if XPREC_USE_FMA
+    return std::fma(-a, b, c);
+#else
+    DDouble p = ExDouble(a) * b;
+    return (c - p.hi()) - p.lo();
+#endif
+}
+
+} // namespace _internal
+
 inline DDouble operator/(ExDouble a, ExDouble b)
 {
     // Since we are rounding faithfully, the hi part is exact
     double th = (double)a / (double)b;
 
     // Multiply hi part with b and compare exactly to a to see difference
-    double rl = std::fma(-(double)b, th, (double)a);
+    double rl = _internal::exact_remainder((double)b, th, (double)a);
     double tl = rl / (double)b;
-    assert(th + tl == th || !std::isfinite(th));
+    assert(th + tl == th || !_internal::is_finite(th));
     return DDouble(th, tl);
 }
 
@@ -124,14 +220,23 @@ inline DDouble DDouble::add_small(DDouble y)
 
 inline DDouble operator*(DDouble x, double y)
 {
+#if XPREC_USE_FMA
     // Algorithm 9: cost 6 flops, error 2 u^2
     DDouble c = ExDouble(x._hi) * y;
     double cl3 = std::fma(x._lo, y, c._lo);
     return ExDouble(c.hi()).add_small(cl3);
+#else
+    // Algorithm 8: cost 22 flops, error 3 u^2
+    DDouble c = ExDouble(x._hi) * y;
+    double cl2 = x._lo * y;
+    double cl3 = c._lo + cl2;
+    return ExDouble(c.hi()).add_small(cl3);
+#endif
 }
 
 inline DDouble operator*(DDouble x, DDouble y)
 {
+#if XPREC_USE_FMA
     // Algorithm 12: cost 9 flops, error 4 u^2 (corrected)
     DDouble c = ExDouble(x._hi) * y._hi;
     double tl0 = x._lo * y._lo;
@@ -139,6 +244,105 @@ inline DDouble operator*(DDouble x, DDouble y)
     double cl2 = std::fma(x._lo, y._hi, tl1);
     double cl3 = c._lo + cl2;
     return ExDouble(c._hi).add_small(cl3);
+#else
+    // Algorithm 10: cost 24 flops, error 7 u^2
+    DDouble c = ExDouble(x._hi) * y._hi;
+    double tl1 = x._hi * y._lo;
+    double tl2 = x._lo * y._hi;
+    double cl2 = tl1 + tl2;
+    double cl3 = c._lo + cl2;
+    return ExDouble(c._hi).add_small(cl3);
+#endif
+}
+
+// -------------------------------------------------------------------------
+// Fused multiply-add
+
+namespace _internal {
+
+/**
+ * Return x * y as in operator*, but without the final renormalization.
+ *
+ * The lo part of the result may exceed half an ulp of the hi part, so it
+ * must be fed into an addition algorithm which renormalizes.  We still have
+ * |lo| <= 3u |hi| (2u |hi| for a double factor) up to O(u^2), which allows
+ * us to bound the error of adding c to p = x * y this way:
+ *
+ * In Algorithms 4 and 6, TwoSum is exact regardless.  Fast2Sum(s, t) is
+ * exact if |s| >= |t| or if s is a multiple of ulp(t).  Where the former
+ * fails, p.hi + c.hi must have cancelled, so s is a multiple of ulp(p.hi)/2,
+ * while |t| = O(u |p.hi|).  Thus, only the roundings contribute: at most
+ * u |p.lo| + u^2 |p + c| <= 3u^2 |p| + u^2 |p + c| in Algorithm 4, and
+ * another u^2 (|c| + |p + c|) <= u^2 |p| + 2u^2 |p + c| in Algorithm 6.
+ */
+inline DDouble unnormalized_product(DDouble x, double y)
+{
+    DDouble c = ExDouble(x.hi()) * y;
+#if XPREC_USE_FMA
+    // Algorithm 9 without last step: cost 3 flops
+    double cl3 = std::fma(x.lo(), y, c.lo());
+#else
+    // Algorithm 8 without last step: cost 19 flops
+    double cl3 = c.lo() + x.lo() * y;
+#endif
+    return DDouble(c.hi(), cl3);
+}
+
+inline DDouble unnormalized_product(DDouble x, DDouble y)
+{
+    DDouble c = ExDouble(x.hi()) * y.hi();
+#if XPREC_USE_FMA
+    // Algorithm 12 without last step: cost 6 flops
+    double tl0 = x.lo() * y.lo();
+    double tl1 = std::fma(x.hi(), y.lo(), tl0);
+    double cl2 = std::fma(x.lo(), y.hi(), tl1);
+#else
+    // Algorithm 10 without last step: cost 21 flops
+    double cl2 = x.hi() * y.lo() + x.lo() * y.hi();
+#endif
+    return DDouble(c.hi(), c.lo() + cl2);
+}
+
+} // namespace _internal
+
+inline DDouble fma(ExDouble a, ExDouble b, ExDouble c)
+{
+    // Algorithm 3 and 4: cost 12 flops, error 2 u^2
+    return (a * b) + (double)c;
+}
+
+inline DDouble fma(DDouble a, DDouble b, DDouble c)
+{
+    // Algorithm 12 and 6, unnormalized: cost 26 flops (instead of 29),
+    // error 8 u^2 |ab| + 3 u^2 |ab + c| (see above)
+    return _internal::unnormalized_product(a, b) + c;
+}
+
+inline DDouble fma(DDouble a, DDouble b, double c)
+{
+    // Algorithm 12 and 4, unnormalized: cost 16 flops (instead of 19),
+    // error 7 u^2 |ab| + u^2 |ab + c| (see above)
+    return _internal::unnormalized_product(a, b) + c;
+}
+
+inline DDouble fma(DDouble a, double b, DDouble c)
+{
+    // Algorithm 9 and 6, unnormalized: cost 23 flops (instead of 26),
+    // error 5 u^2 |ab| + 3 u^2 |ab + c| (see above)
+    return _internal::unnormalized_product(a, b) + c;
+}
+
+inline DDouble fma(DDouble a, double b, double c)
+{
+    // Algorithm 9 and 4, unnormalized: cost 13 flops (instead of 16),
+    // error 4 u^2 |ab| + u^2 |ab + c| (see above)
+    return _internal::unnormalized_product(a, b) + c;
+}
+
+inline DDouble fma(double a, double b, DDouble c)
+{
+    // Algorithm 3 and 6: cost 22 flops, error 3 u^2
+    return (ExDouble(a) * b) + c;
 }
 
 inline DDouble operator/(DDouble x, double y)
@@ -155,12 +359,24 @@ inline DDouble operator/(DDouble x, double y)
 
 inline DDouble reciprocal(DDouble y)
 {
-    // Part of Algorithm 18: cost 19 flops, error 2.3 u^2
+    // Part of Algorithm 18: cost 23 flops, error 2 u^2 (1 u^2 obs.)
+    //
+    // The remainder rh may be smaller in magnitude than rl, so we cannot
+    // use Fast2Sum to add them.  Also, with e = 1 - y th, we have:
+    //
+    //   1/y = th / (1 - e) = th (1 + e + e^2 + ...)
+    //
+    // Since |e| <= 2u, the term e^2 still matters, and we add it to e.
     double th = 1.0 / y._hi;
-    double rh = std::fma(-y._hi, th, 1.0);
+    double rh = _internal::exact_remainder(y._hi, th, 1.0);
     double rl = -y._lo * th;
-    DDouble e = ExDouble(rh).add_small(rl);
-    DDouble delta = e * th;
+    DDouble e = ExDouble(rh) + rl;
+#if XPREC_USE_FMA
+    double el = std::fma(e._hi, e._hi, e._lo);
+#else
+    double el = e._lo + e._hi * e._hi;
+#endif
+    DDouble delta = DDouble(e._hi, el) * th;
 
     // This saves 3 flops w.r.t. algorithm 18, which uses standard addition.
     // We should be able to do this since Taylor expanding gives:
@@ -172,13 +388,13 @@ inline DDouble reciprocal(DDouble y)
 
 inline DDouble operator/(DDouble x, DDouble y)
 {
-    // Algorithm 18: cost 28 flops, error 10 u^2 (6 u^2 obs.)
+    // Algorithm 18: cost 32 flops, error 6 u^2 (4 u^2 obs.)
     return x * reciprocal(y);
 }
 
 inline DDouble operator/(double x, DDouble y)
 {
-    // Algorithm 18: cost 25 flops
+    // Algorithm 18: cost 29 flops
     return x * reciprocal(y);
 }
 
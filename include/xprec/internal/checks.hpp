@@ -39,19 +39,18 @@ inline bool operator>(DDouble x, DDouble y)
     return x.hi() > y.hi() || (x.hi() == y.hi() && x.lo() > y.lo());
 }
 
-inline bool isfinite(DDouble x) { return std::isfinite(x.hi()); }
+inline bool isfinite(DDouble x) { return _internal::is_finite(x.hi()); }
 
-inline bool isinf(DDouble x) { return std::isinf(x.hi()); }
+inline bool isinf(DDouble x) { return _internal::is_inf(x.hi()); }
 
-inline bool isnan(DDouble x) { return std::isnan(x.hi()); }
+inline bool isnan(DDouble x) { return _internal::is_nan(x.hi()); }
 
 inline bool isnormal(DDouble x)
 {
     // Denormalization is double-double is a bit of a strange concept,
     // since the lo part may be a denormalized number even if the whole
     // number is still "normal".
-    constexpr double eps_d = std::numeric_limits<double>::epsilon();
-    return std::isnormal(x.hi() * eps_d);
+    return _internal::is_normal(x.hi() * DBL_EPSILON);
 }
 
 inline bool iszero(DDouble x) { return x.hi() == 0; }
@@ -34,14 +34,14 @@ inline int ilogb(DDouble x) { return std::ilogb(x.hi()); }
 
 inline DDouble logb(DDouble x) { return std::logb(x.hi()); }
 
-inline bool signbit(DDouble a) { return std::signbit(a.hi()); }
+inline bool signbit(DDouble a) { return _internal::sign_bit(a.hi()); }
 
 inline DDouble copysign(DDouble mag, double sgn)
 {
     // The sign is determined by the hi part, however, the sign of hi and lo
     // need not be the same, so we cannot merely broadcast copysign to both
     // parts.
-    return signbit(mag) != std::signbit(sgn) ? -mag : mag;
+    return signbit(mag) != _internal::sign_bit(sgn) ? -mag : mag;
 }
 
 inline DDouble copysign(DDouble mag, DDouble sgn)
@@ -106,7 +106,8 @@ inline DDouble trunc(DDouble x)
     //
     // This may actually increase the  magnitude above the limit, so let's
     // renormalize to be safe.
-    double lo = std::signbit(x.hi()) ? std::ceil(x.lo()) : std::floor(x.lo());
+    double lo = _internal::sign_bit(x.hi()) ? std::ceil(x.lo())
+                                            : std::floor(x.lo());
     return ExDouble(x.hi()).add_small(lo);
 }
 
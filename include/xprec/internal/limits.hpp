@@ -7,49 +7,49 @@
  */
 #include "../ddouble.hpp"
 
+// Where possible, the limits of double are taken from <cfloat> rather than
+// from numeric_limits<double>, whose member functions unoptimized builds call
+// at runtime and emit with external linkage (see internal/arith.hpp).
+
 constexpr xprec::DDouble std::numeric_limits<xprec::DDouble>::min() noexcept
 {
     // Whereas the maximum exponent is the same for double and DDouble,
     // Denormalization in the low part means that the min exponent for
     // normalized values is lower.
-    return DDouble(_double::min() / _double::epsilon());
+    return DDouble(DBL_MIN / DBL_EPSILON);
 }
 
 constexpr xprec::DDouble std::numeric_limits<xprec::DDouble>::max() noexcept
 {
-    return DDouble(_double::max(),
-                   _double::max() * _double::epsilon()
-                        / _double::radix / _double::radix);
+    return DDouble(DBL_MAX, DBL_MAX * DBL_EPSILON / FLT_RADIX / FLT_RADIX);
 }
 
 constexpr xprec::DDouble std::numeric_limits<xprec::DDouble>::lowest() noexcept
 {
-    return DDouble(_double::lowest(),
-                   _double::lowest() * _double::epsilon()
-                        / _double::radix / _double::radix);
+    return DDouble(-DBL_MAX, -DBL_MAX * DBL_EPSILON / FLT_RADIX / FLT_RADIX);
 }
 
 constexpr xprec::DDouble std::numeric_limits<xprec::DDouble>::epsilon() noexcept
 {
-    return DDouble(_double::epsilon() * _double::epsilon() / _double::radix);
+    return DDouble(DBL_EPSILON * DBL_EPSILON / FLT_RADIX);
 }
 
 constexpr xprec::DDouble
 std::numeric_limits<xprec::DDouble>::round_error() noexcept
 {
-    return DDouble(_double::round_error());
+    return DDouble(0.5);
 }
 
 constexpr xprec::DDouble
 std::numeric_limits<xprec::DDouble>::infinity() noexcept
 {
-    return DDouble(_double::infinity(), _double::infinity());
+    return DDouble(HUGE_VAL, HUGE_VAL);
 }
 
 constexpr xprec::DDouble
 std::numeric_limits<xprec::DDouble>::quiet_NaN() noexcept
 {
-    return DDouble(_double::quiet_NaN(), _double::quiet_NaN());
+    return DDouble(NAN, NAN);
 }
 
 constexpr xprec::DDouble
@@ -61,5 +61,5 @@ std::numeric_limits<xprec::DDouble>::signaling_NaN() noexcept
 constexpr xprec::DDouble
 std::numeric_limits<xprec::DDouble>::denorm_min() noexcept
 {
-    return DDouble(_double::denorm_min());
+    return DDouble(DBL_MIN * DBL_EPSILON);
 }
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "../ddouble.hpp"
+#include <cassert>
 #include <limits>
 
 namespace xprec {
@@ -29,6 +30,18 @@ inline uint64_t bit_pattern(double x)
     return x_u.pattern;
 }
 
+/**
+ * Returns the double number with the given bit pattern.
+ */
+inline double from_bit_pattern(uint64_t pattern)
+{
+    union {
+        uint64_t pattern;
+        double number;
+    } x_u = {pattern};
+    return x_u.number;
+}
+
 /**
  * Return true if x is greater or equal in magnitude as y.
  *
@@ -71,6 +84,25 @@ inline uint64_t mantissa_bits(double x)
     return bit_pattern(x) & mantissa_mask;
 }
 
+/**
+ * Return the exponent of a normal number, i.e., ilogb(x) without the checks.
+ */
+inline int normal_exponent(double x)
+{
+    static_assert(std::numeric_limits<double>::is_iec559, "needs IEEE floats");
+    return (int)((bit_pattern(x) >> 52) & 0x7FF) - 1023;
+}
+
+/**
+ * Return 2^n for n in the range of normal numbers, i.e., -1022 <= n <= 1023.
+ */
+inline PowerOfTwo normal_power_of_two(int n)
+{
+    static_assert(std::numeric_limits<double>::is_iec559, "needs IEEE floats");
+    assert(n >= -1022 && n <= 1023);
+    return from_bit_pattern((uint64_t)(n + 1023) << 52);
+}
+
 /**
  * Return true if the mantissa part of a number is zero.
  */
@@ -0,0 +1,235 @@
+/* Small double-double arithmetic library - lazily evaluated expressions
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <type_traits>
+
+#include "accumulator.hpp"
+#include "ddouble.hpp"
+
+namespace xprec {
+
+template <typename Expr>
+class Lazy;
+
+namespace _lazy {
+
+/** Single value */
+struct Value {
+    DDouble x;
+
+    DDouble eval() const { return x; }
+
+    void accumulate(Accumulator &acc, bool negate) const
+    {
+        acc += negate ? -x : x;
+    }
+};
+
+/** Product of a DDouble and T, which is either DDouble or double */
+template <typename T>
+struct Product {
+    DDouble a;
+    T b;
+
+    DDouble eval() const { return a * b; }
+
+    void accumulate(Accumulator &acc, bool negate) const
+    {
+        acc.add_product(negate ? -a : a, b);
+    }
+};
+
+/** Sum (or difference, if SUBTRACT is set) of two expressions */
+template <typename L, typename R, bool SUBTRACT>
+struct Sum {
+    L l;
+    R r;
+
+    DDouble eval() const
+    {
+        Accumulator acc;
+        accumulate(acc, false);
+        return acc.value();
+    }
+
+    void accumulate(Accumulator &acc, bool negate) const
+    {
+        l.accumulate(acc, negate);
+        r.accumulate(acc, negate != SUBTRACT);
+    }
+};
+
+/** Negated expression */
+template <typename E>
+struct Negate {
+    E e;
+
+    DDouble eval() const { return -e.eval(); }
+
+    void accumulate(Accumulator &acc, bool negate) const
+    {
+        e.accumulate(acc, !negate);
+    }
+};
+
+/**
+ * Operands of lazy expressions.
+ *
+ * expr() returns the expression tree for sums, factor() the value to
+ * multiply with.  The factors of a product are evaluated, so sums are
+ * normalized before being multiplied.
+ */
+template <typename T, typename = void>
+struct Operand { };
+
+template <>
+struct Operand<DDouble> {
+    using Expr = Value;
+    static Value expr(DDouble x) { return {x}; }
+    static DDouble factor(DDouble x) { return x; }
+};
+
+template <typename T>
+struct Operand<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+    using Expr = Value;
+    static Value expr(T x) { return {double(x)}; }
+    static double factor(T x) { return x; }
+};
+
+template <typename E>
+struct Operand<Lazy<E>> {
+    using Expr = E;
+    static E expr(const Lazy<E> &x) { return x.expr(); }
+    static DDouble factor(const Lazy<E> &x) { return x.eval(); }
+};
+
+template <typename T>
+struct IsLazy : std::false_type { };
+
+template <typename E>
+struct IsLazy<Lazy<E>> : std::true_type { };
+
+/** Enable operator if one of the operands is lazy */
+template <typename X, typename Y, typename Result>
+using EnableFor = typename std::enable_if<
+        IsLazy<X>::value || IsLazy<Y>::value, Result>::type;
+
+inline Product<DDouble> product(DDouble a, DDouble b) { return {a, b}; }
+
+inline Product<double> product(DDouble a, double b) { return {a, b}; }
+
+inline Product<double> product(double a, DDouble b) { return {b, a}; }
+
+template <typename X, typename Y>
+using ProductOf = decltype(product(Operand<X>::factor(std::declval<X>()),
+                                   Operand<Y>::factor(std::declval<Y>())));
+
+template <typename X, typename Y, bool SUBTRACT>
+using SumOf = Sum<typename Operand<X>::Expr, typename Operand<Y>::Expr,
+                  SUBTRACT>;
+
+} /* namespace _lazy */
+
+/**
+ * Lazily evaluated double-double expression.
+ *
+ * Created by lazy() and the arithmetic operators on lazy expressions.  The
+ * expression is evaluated when converted to DDouble or when calling eval().
+ * Operands are stored by value, so lazy expressions may outlive them.
+ */
+template <typename Expr>
+class Lazy {
+public:
+    explicit constexpr Lazy(Expr expr) : _expr(expr) { }
+
+    /** Evaluate expression */
+    DDouble eval() const { return _expr.eval(); }
+
+    /** Evaluate expression */
+    operator DDouble() const { return eval(); }
+
+    /** Return expression tree */
+    const Expr &expr() const { return _expr; }
+
+private:
+    Expr _expr;
+};
+
+/**
+ * Start a lazily evaluated expression.
+ *
+ * Sums and differences of products involving lazy expressions are collected
+ * in an expression tree, which is evaluated as a whole when converted to
+ * DDouble.  The products are not normalized, but added to an Accumulator
+ * with shared error-free transformations, which is normalized only once at
+ * the end.  For example,
+ *
+ *     DDouble r = xprec::lazy(a) * b + c * d - e;
+ *
+ * costs 14 + 9 + 8 + 8 + 6 = 45 flops instead of 9 + 9 + 20 + 20 = 58 flops
+ * if all operands are DDouble.  Here, c * d is evaluated eagerly, since
+ * neither operand is lazy; writing lazy(c) * d saves another 3 flops.
+ *
+ * The products are rounded as for operator*, but not normalized, so their
+ * lo parts are bounded by 3u times their hi parts.  The rounding errors of
+ * the lo parts are summed up in a double, so for k <= Accumulator::RENORM
+ * terms, the sum adds an error of at most (k (k - 1)/2 + 4k - 1) u² times
+ * the sum of the magnitudes of the terms, e.g., 14 u² for k = 3.  This is
+ * weaker than the 3 (k - 1) u² for the operators, which normalize after
+ * every addition, in exchange for the flops saved; the largest observed
+ * errors are about twice those of the operators.  Longer sums are
+ * normalized every RENORM terms.  Divisions and products of sums evaluate
+ * their operands first.
+ */
+inline Lazy<_lazy::Value> lazy(DDouble x)
+{
+    return Lazy<_lazy::Value>(_lazy::Value{x});
+}
+
+template <typename X, typename Y>
+_lazy::EnableFor<X, Y, Lazy<_lazy::SumOf<X, Y, false>>>
+operator+(const X &x, const Y &y)
+{
+    return Lazy<_lazy::SumOf<X, Y, false>>(
+            {_lazy::Operand<X>::expr(x), _lazy::Operand<Y>::expr(y)});
+}
+
+template <typename X, typename Y>
+_lazy::EnableFor<X, Y, Lazy<_lazy::SumOf<X, Y, true>>>
+operator-(const X &x, const Y &y)
+{
+    return Lazy<_lazy::SumOf<X, Y, true>>(
+            {_lazy::Operand<X>::expr(x), _lazy::Operand<Y>::expr(y)});
+}
+
+template <typename X, typename Y>
+_lazy::EnableFor<X, Y, Lazy<_lazy::ProductOf<X, Y>>>
+operator*(const X &x, const Y &y)
+{
+    return Lazy<_lazy::ProductOf<X, Y>>(_lazy::product(
+            _lazy::Operand<X>::factor(x), _lazy::Operand<Y>::factor(y)));
+}
+
+template <typename X, typename Y>
+_lazy::EnableFor<X, Y, Lazy<_lazy::Value>>
+operator/(const X &x, const Y &y)
+{
+    return lazy(_lazy::Operand<X>::factor(x) / _lazy::Operand<Y>::factor(y));
+}
+
+template <typename E>
+Lazy<_lazy::Negate<E>> operator-(const Lazy<E> &x)
+{
+    return Lazy<_lazy::Negate<E>>(_lazy::Negate<E>{x.expr()});
+}
+
+template <typename E>
+Lazy<E> operator+(const Lazy<E> &x)
+{
+    return x;
+}
+
+} /* namespace xprec */
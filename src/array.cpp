@@ -0,0 +1,216 @@
+/* Elementwise arithmetic on arrays of double-doubles.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "simd.hpp"
+#include "xprec/array.hpp"
+#include "xprec/ddouble.hpp"
+#include "xprec/internal/utils.hpp"
+#include <atomic>
+#include <cassert>
+
+#ifndef XPREC_API_EXPORT
+#define XPREC_API_EXPORT
+#endif
+
+namespace xprec {
+
+// Kernels compiled for whatever instruction set the library is compiled for.
+static const _simd::Kernels BASELINE_KERNELS =
+    _simd::KernelsFor<_simd::Native>::table();
+
+// Currently selected SIMD level, or -1 if it has not been detected yet.
+static std::atomic<int> current_simd_level(-1);
+
+static bool cpu_supports(SimdLevel level)
+{
+#ifdef XPREC_SIMD_DISPATCH
+    // This also checks whether the OS saves the extended registers.
+    __builtin_cpu_init();
+    switch (level) {
+    case SimdLevel::AVX512:
+        return __builtin_cpu_supports("avx512f")
+               && __builtin_cpu_supports("fma");
+    case SimdLevel::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    default:
+        return true;
+    }
+#else
+    return level == SimdLevel::SCALAR;
+#endif
+}
+
+static const _simd::Kernels &kernels_for(SimdLevel level)
+{
+    switch (level) {
+#ifdef XPREC_SIMD_DISPATCH
+    case SimdLevel::AVX512:
+        return _simd::AVX512_KERNELS;
+    case SimdLevel::AVX2:
+        return _simd::AVX2_KERNELS;
+#endif
+    default:
+        return BASELINE_KERNELS;
+    }
+}
+
+XPREC_API_EXPORT
+SimdLevel set_simd_level(SimdLevel max_level)
+{
+    SimdLevel level = max_level;
+    while (!cpu_supports(level))
+        level = SimdLevel(int(level) - 1);
+
+    current_simd_level.store(int(level), std::memory_order_relaxed);
+    return level;
+}
+
+XPREC_API_EXPORT
+SimdLevel simd_level()
+{
+    int level = current_simd_level.load(std::memory_order_relaxed);
+    if (level < 0)
+        return set_simd_level(SimdLevel::AVX512);
+    return SimdLevel(level);
+}
+
+XPREC_API_EXPORT
+const _simd::Kernels &_simd::current_kernels()
+{
+    return kernels_for(simd_level());
+}
+
+static const _simd::Kernels &kernels() { return _simd::current_kernels(); }
+
+XPREC_API_EXPORT
+void add(ConstDDoubleSpan x, ConstDDoubleSpan y, DDoubleSpan out)
+{
+    assert(x.size() == out.size() && y.size() == out.size());
+    kernels().add(out.size(), x.hi(), x.lo(), y.hi(), y.lo(), out.hi(),
+                  out.lo());
+}
+
+XPREC_API_EXPORT
+void sub(ConstDDoubleSpan x, ConstDDoubleSpan y, DDoubleSpan out)
+{
+    assert(x.size() == out.size() && y.size() == out.size());
+    kernels().sub(out.size(), x.hi(), x.lo(), y.hi(), y.lo(), out.hi(),
+                  out.lo());
+}
+
+XPREC_API_EXPORT
+void mul(ConstDDoubleSpan x, ConstDDoubleSpan y, DDoubleSpan out)
+{
+    assert(x.size() == out.size() && y.size() == out.size());
+    kernels().mul(out.size(), x.hi(), x.lo(), y.hi(), y.lo(), out.hi(),
+                  out.lo());
+}
+
+XPREC_API_EXPORT
+void div(ConstDDoubleSpan x, ConstDDoubleSpan y, DDoubleSpan out)
+{
+    assert(x.size() == out.size() && y.size() == out.size());
+    kernels().div(out.size(), x.hi(), x.lo(), y.hi(), y.lo(), out.hi(),
+                  out.lo());
+}
+
+XPREC_API_EXPORT
+void div(ConstDDoubleSpan x, DDouble y, DDoubleSpan out)
+{
+    // x / y is defined as x * reciprocal(y), so we can hoist the reciprocal
+    // out of the loop and still give bit-identical results.
+    assert(x.size() == out.size());
+    DDouble r = reciprocal(y);
+    kernels().scale_right(r.hi(), r.lo(), out.size(), x.hi(), x.lo(),
+                          out.hi(), out.lo());
+}
+
+XPREC_API_EXPORT
+void reciprocal(ConstDDoubleSpan x, DDoubleSpan out)
+{
+    assert(x.size() == out.size());
+    kernels().reciprocal(out.size(), x.hi(), x.lo(), out.hi(), out.lo());
+}
+
+// Values whose magnitude is in [1/SAFE_MAX, SAFE_MAX] can be multiplied
+// pairwise without overflow or underflow, even including the lo part.
+static const PowerOfTwo RECIPROCAL_BATCH_SAFE_MAX = ldexp(PowerOfTwo(1), 480);
+
+static bool reciprocal_batch_safe(DDouble x)
+{
+    using _internal::greater_in_magnitude;
+    const PowerOfTwo safe_max = RECIPROCAL_BATCH_SAFE_MAX;
+    return greater_in_magnitude(safe_max, x)
+           && greater_in_magnitude(x, reciprocal(safe_max));
+}
+
+XPREC_API_EXPORT
+void reciprocal_batch(ConstDDoubleSpan x, DDoubleSpan out)
+{
+    // Montgomery's trick: with the prefix products p[k] = x[0] * ... * x[k],
+    // we have 1/x[k] = p[k-1] / p[m-1] * x[k+1] * ... * x[m-1], so a single
+    // reciprocal of p[m-1] suffices for m values.  Segments are cut short
+    // whenever an element or a product leaves the safe range.
+    assert(x.size() == out.size());
+    const size_t n = x.size();
+    DDouble prefix[RECIPROCAL_BATCH_SEGMENT];
+
+    size_t i = 0;
+    while (i != n) {
+        DDouble xi = x[i];
+        if (!reciprocal_batch_safe(xi)) {
+            // Zero and non-finite values get the IEEE result, very small and
+            // very large values are handled one-by-one.
+            if (iszero(xi) || !isfinite(xi))
+                out[i] = 1.0 / xi.hi();
+            else
+                out[i] = reciprocal(xi);
+            ++i;
+            continue;
+        }
+
+        // Forward pass: one multiplication per element
+        prefix[0] = xi;
+        size_t m = 1;
+        for (; m != RECIPROCAL_BATCH_SEGMENT && i + m != n; ++m) {
+            DDouble xm = x[i + m];
+            if (!reciprocal_batch_safe(xm))
+                break;
+
+            DDouble p = prefix[m - 1] * xm;
+            if (!reciprocal_batch_safe(p))
+                break;
+            prefix[m] = p;
+        }
+
+        // Backward pass: two multiplications per element.  Read x before
+        // writing out, since the two may alias.
+        DDouble inv = reciprocal(prefix[m - 1]);
+        for (size_t k = m - 1; k != 0; --k) {
+            DDouble xk = x[i + k];
+            out[i + k] = inv * prefix[k - 1];
+            inv *= xk;
+        }
+        out[i] = inv;
+        i += m;
+    }
+}
+
+XPREC_API_EXPORT
+void mul(DDouble a, ConstDDoubleSpan x, DDoubleSpan out)
+{
+    assert(x.size() == out.size());
+    kernels().scale(a.hi(), a.lo(), out.size(), x.hi(), x.lo(), out.hi(),
+                    out.lo());
+}
+
+XPREC_API_EXPORT
+void axpy(DDouble a, ConstDDoubleSpan x, DDoubleSpan y)
+{
+    assert(x.size() == y.size());
+    kernels().axpy(a.hi(), a.lo(), y.size(), x.hi(), x.lo(), y.hi(), y.lo());
+}
+
+} /* namespace xprec */
@@ -0,0 +1,537 @@
+/* Linear algebra kernels for double-doubles.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "simd.hpp"
+#include "xprec/blas.hpp"
+#include "xprec/ddouble.hpp"
+#include "xprec/internal/utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#ifndef XPREC_API_EXPORT
+#define XPREC_API_EXPORT
+#endif
+
+namespace xprec {
+
+// Kernels operate on split hi and lo arrays with a stride, so arrays of
+// DDouble are passed as the hi and lo parts of the first element and an
+// increment of twice the number of elements.
+static const double *hi_part(const DDouble *x)
+{
+    return reinterpret_cast<const double *>(x);
+}
+
+static double *hi_part(DDouble *x) { return reinterpret_cast<double *>(x); }
+
+static DDouble dot_impl(size_t n, const double *xhi, const double *xlo,
+                        size_t incx, const double *yhi, const double *ylo,
+                        size_t incy)
+{
+    double result[2];
+    _simd::current_kernels().dot(n, xhi, xlo, incx, yhi, ylo, incy, result);
+    return DDouble(result[0], result[1]);
+}
+
+XPREC_API_EXPORT
+DDouble dot(size_t n, const DDouble *x, size_t incx, const DDouble *y,
+            size_t incy)
+{
+    return dot_impl(n, hi_part(x), hi_part(x) + 1, 2 * incx, hi_part(y),
+                    hi_part(y) + 1, 2 * incy);
+}
+
+XPREC_API_EXPORT
+DDouble dot(ConstDDoubleSpan x, ConstDDoubleSpan y)
+{
+    assert(x.size() == y.size());
+    return dot_impl(x.size(), x.hi(), x.lo(), 1, y.hi(), y.lo(), 1);
+}
+
+XPREC_API_EXPORT
+DDouble dot2(const double *x, const double *y, size_t n)
+{
+    double result[2];
+    _simd::current_kernels().dot2(n, x, y, result);
+    return DDouble(result[0], result[1]);
+}
+
+static DDouble sum_impl(size_t n, const double *xhi, const double *xlo,
+                        size_t incx)
+{
+    double result[2];
+    _simd::current_kernels().sum(n, xhi, xlo, incx, result);
+    return DDouble(result[0], result[1]);
+}
+
+XPREC_API_EXPORT
+DDouble sum(size_t n, const DDouble *x, size_t incx)
+{
+    return sum_impl(n, hi_part(x), hi_part(x) + 1, 2 * incx);
+}
+
+XPREC_API_EXPORT
+DDouble sum(ConstDDoubleSpan x)
+{
+    return sum_impl(x.size(), x.hi(), x.lo(), 1);
+}
+
+XPREC_API_EXPORT
+DDouble sum(const double *x, size_t n)
+{
+    double result[2];
+    _simd::current_kernels().sum_double(n, x, result);
+    return DDouble(result[0], result[1]);
+}
+
+static DDouble asum_impl(size_t n, const double *xhi, const double *xlo,
+                         size_t incx)
+{
+    double result[2];
+    _simd::current_kernels().asum(n, xhi, xlo, incx, result);
+    return DDouble(result[0], result[1]);
+}
+
+XPREC_API_EXPORT
+DDouble asum(size_t n, const DDouble *x, size_t incx)
+{
+    return asum_impl(n, hi_part(x), hi_part(x) + 1, 2 * incx);
+}
+
+XPREC_API_EXPORT
+DDouble asum(ConstDDoubleSpan x)
+{
+    return asum_impl(x.size(), x.hi(), x.lo(), 1);
+}
+
+// If the sum of squares is at least this large, we know that no square that
+// matters was subnormal, so the sum is accurate.
+static const PowerOfTwo NRM2_SAFE_MIN = ldexp(PowerOfTwo(1), -900);
+
+static DDouble nrm2_impl(size_t n, const double *xhi, const double *xlo,
+                         size_t incx)
+{
+    const _simd::Kernels &kernels = _simd::current_kernels();
+
+    // Optimistically assume that we neither overflow nor underflow
+    double result[2];
+    kernels.sum_squares(1.0, n, xhi, xlo, incx, result);
+    DDouble sum(result[0], result[1]);
+    if (isfinite(sum) && !(sum.hi() < NRM2_SAFE_MIN))
+        return sqrt(sum);
+
+    // Infinities and NaNs (which abs_max may ignore) propagate through.
+    double max_hi = kernels.abs_max(n, xhi, incx);
+    if (!std::isfinite(max_hi))
+        return max_hi;
+    if (max_hi == 0.0)
+        return sum;
+
+    // Like hypot, scale by a power of two to avoid overflow or underflow.
+    // This time, we bring the largest element to unity.
+    int exponent = std::min(-std::ilogb(max_hi), 1000);
+    PowerOfTwo scale = ldexp(PowerOfTwo(1), exponent);
+    kernels.sum_squares(scale, n, xhi, xlo, incx, result);
+    DDouble norm = sqrt(DDouble(result[0], result[1]));
+    return norm * ldexp(PowerOfTwo(1), -exponent);
+}
+
+XPREC_API_EXPORT
+DDouble nrm2(size_t n, const DDouble *x, size_t incx)
+{
+    return nrm2_impl(n, hi_part(x), hi_part(x) + 1, 2 * incx);
+}
+
+XPREC_API_EXPORT
+DDouble nrm2(ConstDDoubleSpan x)
+{
+    return nrm2_impl(x.size(), x.hi(), x.lo(), 1);
+}
+
+// Number of elements, for which iamax first checks if any can be larger than
+// the largest element so far.
+static const size_t IAMAX_BLOCK = 256;
+
+static size_t iamax_impl(size_t n, const double *xhi, const double *xlo,
+                         size_t incx)
+{
+    if (n == 0)
+        return 0;
+
+    const _simd::Kernels &kernels = _simd::current_kernels();
+    size_t best = 0;
+    DDouble best_abs = fabs(DDouble(xhi[0], xlo[0]));
+    for (size_t i0 = 0; i0 < n; i0 += IAMAX_BLOCK) {
+        // Since the elements are normalized, |x[i].hi| < |best.hi| implies
+        // |x[i]| < |best|, so we can skip the block.
+        size_t m = std::min(IAMAX_BLOCK, n - i0);
+        if (kernels.abs_max(m, xhi + i0 * incx, incx) < best_abs.hi())
+            continue;
+
+        for (size_t i = i0; i != i0 + m; ++i) {
+            DDouble xi = fabs(DDouble(xhi[i * incx], xlo[i * incx]));
+            if (xi > best_abs) {
+                best_abs = xi;
+                best = i;
+            }
+        }
+    }
+    return best;
+}
+
+XPREC_API_EXPORT
+size_t iamax(size_t n, const DDouble *x, size_t incx)
+{
+    return iamax_impl(n, hi_part(x), hi_part(x) + 1, 2 * incx);
+}
+
+XPREC_API_EXPORT
+size_t iamax(ConstDDoubleSpan x)
+{
+    return iamax_impl(x.size(), x.hi(), x.lo(), 1);
+}
+
+XPREC_API_EXPORT
+void axpy(size_t n, DDouble a, const DDouble *x, size_t incx, DDouble *y,
+          size_t incy)
+{
+    const _simd::Kernels &kernels = _simd::current_kernels();
+    kernels.axpy_strided(a.hi(), a.lo(), n, hi_part(x), hi_part(x) + 1,
+                         2 * incx, hi_part(y), hi_part(y) + 1, 2 * incy);
+}
+
+XPREC_API_EXPORT
+void scal(size_t n, DDouble a, DDouble *x, size_t incx)
+{
+    const _simd::Kernels &kernels = _simd::current_kernels();
+    kernels.scale_strided(a.hi(), a.lo(), n, hi_part(x), hi_part(x) + 1,
+                          2 * incx);
+}
+
+XPREC_API_EXPORT
+void scal(DDouble a, DDoubleSpan x) { mul(a, x, x); }
+
+// Minimum number of terms per thread for the reproducible reductions.
+static const size_t REPRO_MIN_WORK = 1 << 16;
+
+/** Call fn(begin, end, out) on contiguous parts of [0, n) in parallel */
+template <typename Fn>
+static std::vector<double> split_terms(size_t n, size_t nout, Fn fn)
+{
+    size_t nthreads = std::min<size_t>(gemm_threads(), n / REPRO_MIN_WORK);
+    nthreads = std::max<size_t>(nthreads, 1);
+
+    // Each thread gets its own part of out, which is zero-initialized.
+    std::vector<double> out(nthreads * nout, 0.0);
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < nthreads; ++t) {
+        threads.emplace_back(fn, t * n / nthreads, (t + 1) * n / nthreads,
+                             &out[t * nout]);
+    }
+    fn(0, n / nthreads, out.data());
+    for (std::thread &thread : threads)
+        thread.join();
+    return out;
+}
+
+static DDouble reproducible_impl(const _simd::TermArgs &terms, size_t n)
+{
+    const _simd::Kernels &kernels = _simd::current_kernels();
+
+    // First pass: find the largest hi part and check for non-finite terms,
+    // in which case the plain sum carries the infinity or NaN.
+    std::vector<double> stats = split_terms(
+            n, 3, [&](size_t begin, size_t end, double *out) {
+                kernels.term_stats(terms, begin, end, out);
+            });
+    double amax = 0.0, total = 0.0, flag = 0.0;
+    for (size_t t = 0; t < stats.size(); t += 3) {
+        amax = std::max(amax, stats[t]);
+        total += stats[t + 1];
+        flag += stats[t + 2];
+    }
+    if (!std::isfinite(amax) || std::isnan(flag))
+        return total;
+    if (amax == 0.0)
+        return 0.0;
+
+    // Every level gets at most 2n terms (hi parts and remainders at level 0,
+    // remainders and lo parts at the others), each below 2^(E[k] - L), so
+    // the bins cannot overflow.  Every level thus resolves 53 - L bits, and
+    // we add levels until the remainders are below 2^-107 of the largest term.
+    int nbits = 2;
+    while (nbits < 64 && (size_t(1) << nbits) < 2 * n)
+        ++nbits;
+    assert(nbits <= 39);
+    size_t levels = (108 + (53 - nbits) - 1) / (53 - nbits);
+    assert(levels <= _simd::BINNED_MAX_LEVELS);
+
+    // Scale by a power of two, such that neither the largest bin overflows
+    // nor the smallest resolution underflows.
+    int top = std::ilogb(amax) + 1 + nbits;
+    int bottom = top + int(levels - 1) * (nbits - 53) - 52;
+    int exponent = 0;
+    if (top > 1020)
+        exponent = 1020 - top;
+    else if (bottom < -1074)
+        exponent = -1074 - bottom;
+
+    double m[_simd::BINNED_MAX_LEVELS];
+    for (size_t k = 0; k != levels; ++k)
+        m[k] = std::ldexp(1.5, top + exponent + int(k) * (nbits - 53));
+
+    // Second pass: the sums of every level are exact, so it does not matter
+    // how the terms are split across threads.
+    double scale = std::ldexp(1.0, exponent);
+    std::vector<double> sums = split_terms(
+            n, levels, [&](size_t begin, size_t end, double *out) {
+                kernels.binned_sum(terms, begin, end, scale, m, levels, out);
+            });
+    double bins[_simd::BINNED_MAX_LEVELS] = {};
+    for (size_t t = 0; t < sums.size(); t += levels) {
+        for (size_t k = 0; k != levels; ++k)
+            bins[k] += sums[t + k];
+    }
+
+    DDouble result = bins[0];
+    for (size_t k = 1; k != levels; ++k)
+        result += bins[k];
+    return result * ldexp(PowerOfTwo(1), -exponent);
+}
+
+XPREC_API_EXPORT
+DDouble reproducible_sum(ConstDDoubleSpan x)
+{
+    _simd::TermArgs terms = {_simd::TermArgs::SUM, x.hi(), x.lo(), 1,
+                             nullptr, nullptr, 0};
+    return reproducible_impl(terms, x.size());
+}
+
+XPREC_API_EXPORT
+DDouble reproducible_sum(const double *x, size_t n)
+{
+    _simd::TermArgs terms = {_simd::TermArgs::SUM_DOUBLE, x, nullptr, 1,
+                             nullptr, nullptr, 0};
+    return reproducible_impl(terms, n);
+}
+
+XPREC_API_EXPORT
+DDouble reproducible_dot(ConstDDoubleSpan x, ConstDDoubleSpan y)
+{
+    assert(x.size() == y.size());
+    _simd::TermArgs terms = {_simd::TermArgs::DOT, x.hi(), x.lo(), 1,
+                             y.hi(), y.lo(), 1};
+    return reproducible_impl(terms, x.size());
+}
+
+XPREC_API_EXPORT
+DDouble reproducible_dot(const double *x, const double *y, size_t n)
+{
+    _simd::TermArgs terms = {_simd::TermArgs::DOT_DOUBLE, x, nullptr, 1,
+                             y, nullptr, 1};
+    return reproducible_impl(terms, n);
+}
+
+// Cache blocking of gemm: the packed kc x nr panel of B (16 kB) should stay
+// in L1, the packed mc x kc block of A (256 kB) in L2.  Each tile of C of
+// size mc x nc is one unit of work for the threads.
+static const size_t GEMM_MC = 64;
+static const size_t GEMM_NC = 256;
+static const size_t GEMM_KC = 256;
+
+// Minimum number of multiply-adds per thread, below which spawning a thread
+// is not worth it.
+static const size_t GEMM_MIN_WORK = 64 * 64 * 64;
+
+// Maximum number of threads for gemm, or 0 for the hardware concurrency.
+static std::atomic<unsigned> max_gemm_threads(0);
+
+XPREC_API_EXPORT
+unsigned set_gemm_threads(unsigned max_threads)
+{
+    max_gemm_threads.store(max_threads, std::memory_order_relaxed);
+    return gemm_threads();
+}
+
+XPREC_API_EXPORT
+unsigned gemm_threads()
+{
+    unsigned n = max_gemm_threads.load(std::memory_order_relaxed);
+    if (n == 0)
+        n = std::thread::hardware_concurrency();
+    return n != 0 ? n : 1;
+}
+
+namespace {
+
+/** Read-only view of a matrix with arbitrary row and column strides */
+struct MatrixView {
+    const DDouble *data;
+    size_t rs, cs;
+
+    DDouble operator()(size_t i, size_t j) const
+    {
+        return data[i * rs + j * cs];
+    }
+};
+
+struct GemmProblem {
+    size_t m, n, k;
+    DDouble alpha;
+    MatrixView a, b;
+    DDouble beta;
+    DDouble *c;
+    size_t ldc;
+    const _simd::Kernels *kernels;
+};
+
+/**
+ * Pack mc x kc block of alpha * A starting at (i0, p0).
+ *
+ * The block is split into panels of mr rows, padded with zeros.  For each
+ * p, a panel holds the mr hi parts followed by the mr lo parts.
+ */
+void pack_a(const GemmProblem &g, size_t i0, size_t p0, size_t mc, size_t kc,
+            double *out)
+{
+    const size_t mr = g.kernels->gemm_mr;
+    const bool scale = g.alpha != 1.0;
+    for (size_t ir = 0; ir < mc; ir += mr) {
+        for (size_t p = 0; p != kc; ++p) {
+            for (size_t i = 0; i != mr; ++i) {
+                DDouble aip = 0.0;
+                if (ir + i < mc) {
+                    aip = g.a(i0 + ir + i, p0 + p);
+                    if (scale)
+                        aip = g.alpha * aip;
+                }
+                out[i] = aip.hi();
+                out[mr + i] = aip.lo();
+            }
+            out += 2 * mr;
+        }
+    }
+}
+
+/** Pack kc x nc block of B starting at (p0, j0) into panels of nr columns */
+void pack_b(const GemmProblem &g, size_t p0, size_t j0, size_t kc, size_t nc,
+            double *out)
+{
+    const size_t nr = _simd::GEMM_NR;
+    for (size_t jr = 0; jr < nc; jr += nr) {
+        for (size_t p = 0; p != kc; ++p) {
+            for (size_t j = 0; j != nr; ++j) {
+                DDouble bpj = jr + j < nc ? g.b(p0 + p, j0 + jr + j) : 0.0;
+                out[j] = bpj.hi();
+                out[nr + j] = bpj.lo();
+            }
+            out += 2 * nr;
+        }
+    }
+}
+
+/** Compute the mc x nc tile of C starting at (i0, j0) */
+void gemm_tile(const GemmProblem &g, size_t i0, size_t j0, size_t mc,
+               size_t nc, double *apack, double *bpack)
+{
+    DDouble *c = g.c + i0 + j0 * g.ldc;
+    if (g.beta != 1.0) {
+        for (size_t j = 0; j != nc; ++j) {
+            for (size_t i = 0; i != mc; ++i) {
+                DDouble &cij = c[i + j * g.ldc];
+                cij = g.beta == 0.0 ? DDouble(0.0) : g.beta * cij;
+            }
+        }
+    }
+    if (g.alpha == 0.0)
+        return;
+
+    // Keep the order of the sum over p for the results to be reproducible.
+    for (size_t p0 = 0; p0 < g.k; p0 += GEMM_KC) {
+        size_t kc = std::min(GEMM_KC, g.k - p0);
+        pack_b(g, p0, j0, kc, nc, bpack);
+        pack_a(g, i0, p0, mc, kc, apack);
+        g.kernels->gemm(mc, nc, kc, apack, bpack,
+                        reinterpret_cast<double *>(c), g.ldc);
+    }
+}
+
+/** Compute tiles of C, taking the next free one until none are left */
+void gemm_worker(const GemmProblem &g, std::atomic<size_t> &next_tile)
+{
+    const size_t mtiles = (g.m + GEMM_MC - 1) / GEMM_MC;
+    const size_t ntiles = mtiles * ((g.n + GEMM_NC - 1) / GEMM_NC);
+    std::vector<double> apack(2 * GEMM_MC * GEMM_KC);
+    std::vector<double> bpack(2 * GEMM_NC * GEMM_KC);
+
+    for (;;) {
+        size_t tile = next_tile.fetch_add(1, std::memory_order_relaxed);
+        if (tile >= ntiles)
+            break;
+
+        size_t i0 = tile % mtiles * GEMM_MC;
+        size_t j0 = tile / mtiles * GEMM_NC;
+        size_t mc = std::min(GEMM_MC, g.m - i0);
+        size_t nc = std::min(GEMM_NC, g.n - j0);
+        gemm_tile(g, i0, j0, mc, nc, apack.data(), bpack.data());
+    }
+}
+
+} /* anonymous namespace */
+
+XPREC_API_EXPORT
+void gemm(Transpose transa, Transpose transb, size_t m, size_t n, size_t k,
+          DDouble alpha, const DDouble *a, size_t lda, const DDouble *b,
+          size_t ldb, DDouble beta, DDouble *c, size_t ldc)
+{
+    assert(ldc >= m);
+    assert(lda >= (transa == Transpose::NO ? m : k));
+    assert(ldb >= (transb == Transpose::NO ? k : n));
+    if (m == 0 || n == 0)
+        return;
+    if (k == 0)
+        alpha = 0.0;
+
+    static_assert(GEMM_MC % _simd::GEMM_MAX_MR == 0, "invalid blocking");
+    static_assert(GEMM_NC % _simd::GEMM_NR == 0, "invalid blocking");
+
+    GemmProblem g;
+    g.m = m;
+    g.n = n;
+    g.k = k;
+    g.alpha = alpha;
+    g.a = transa == Transpose::NO ? MatrixView{a, 1, lda}
+                                  : MatrixView{a, lda, 1};
+    g.b = transb == Transpose::NO ? MatrixView{b, 1, ldb}
+                                  : MatrixView{b, ldb, 1};
+    g.beta = beta;
+    g.c = c;
+    g.ldc = ldc;
+    g.kernels = &_simd::current_kernels();
+
+    // Since every tile of C is computed by exactly one thread in the same
+    // way, the result does not depend on the number of threads.
+    size_t ntiles = ((m + GEMM_MC - 1) / GEMM_MC)
+                    * ((n + GEMM_NC - 1) / GEMM_NC);
+    size_t work = m * n * std::max(k, size_t(1));
+    size_t nthreads = std::min<size_t>(gemm_threads(), ntiles);
+    nthreads = std::max<size_t>(std::min(nthreads, work / GEMM_MIN_WORK), 1);
+
+    std::atomic<size_t> next_tile(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < nthreads; ++t)
+        threads.emplace_back(gemm_worker, std::cref(g), std::ref(next_tile));
+
+    gemm_worker(g, next_tile);
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+} /* namespace xprec */
@@ -4,8 +4,10 @@
  * SPDX-License-Identifier: MIT
  */
 #include "taylor.hpp"
+#include "xprec/accumulator.hpp"
 #include "xprec/ddouble.hpp"
 #include "xprec/numbers.hpp"
+#include <utility>
 
 #ifndef XPREC_API_EXPORT
 #define XPREC_API_EXPORT
@@ -20,7 +22,11 @@ DDouble trig_complement(DDouble x)
         return sqrt(ExDouble(1.0).add_small(-x * x));
 
     // Search for a zero of f(y) = y^2 + x^2 - 1
-    ExDouble y0 = std::sqrt(std::fma(x.hi(), -x.hi(), 1));
+#if XPREC_USE_FMA
+    ExDouble y0 = std::sqrt(std::fma(x.hi(), -x.hi(), 1.0));
+#else
+    ExDouble y0 = std::sqrt((1.0 - ExDouble(x.hi()) * x.hi()).hi());
+#endif
 
     // Newton-Ralphson iteration
     //      y = y - f(y) / f'(y) = y - (y^2 + x^2 - 1) / 2 y
@@ -29,133 +35,231 @@ DDouble trig_complement(DDouble x)
     return y;
 }
 
-static DDouble sin_kernel(DDouble x, int n = 13)
+static DDouble sin_pi64(int n)
 {
-    // We need this to go out to pi/4 ~= 0.785
-    // Convergence of the Taylor approx to 2e-32
-    assert(n >= 0 && n <= 13);
+    // sin(n pi/64) for n = 0, ..., 32, such that cos(n pi/64) = sin((32 - n)
+    // pi/64) is in the same table.
+    static const DDouble SIN_PI64[33] = {
+        {0.0, 0.0},
+        {0.049067674327418015, -6.79610372051828e-19},
+        {0.0980171403295606, -1.634582362244256e-18},
+        {0.14673047445536175, 3.726947147046568e-18},
+        {0.19509032201612828, -7.991079068461731e-18},
+        {0.2429801799032639, -8.751431529719663e-18},
+        {0.2902846772544624, -1.892797870777425e-17},
+        {0.33688985339222005, -4.200094003347509e-19},
+        {0.3826834323650898, -1.0050772696461588e-17},
+        {0.4275550934302821, 9.411189816295473e-18},
+        {0.47139673682599764, 6.516678136069013e-18},
+        {0.5141027441932218, -4.5712707523615624e-17},
+        {0.5555702330196022, 4.709410940561677e-17},
+        {0.5956993044924334, -1.3438641936579467e-17},
+        {0.6343932841636455, 1.0420901929280035e-17},
+        {0.6715589548470184, -4.048903774929669e-17},
+        {0.7071067811865476, -4.833646656726457e-17},
+        {0.7409511253549591, -1.4708616952297345e-17},
+        {0.773010453362737, -3.256590703364977e-17},
+        {0.8032075314806449, -3.306060980481491e-17},
+        {0.8314696123025452, 1.4073856984728024e-18},
+        {0.8577286100002721, -4.818344793633662e-17},
+        {0.881921264348355, -1.9843248405890562e-17},
+        {0.9039892931234433, -6.609754468748431e-18},
+        {0.9238795325112867, 1.7645047084336677e-17},
+        {0.9415440651830208, -2.789637954769834e-17},
+        {0.9569403357322088, 4.05538698618757e-17},
+        {0.970031253194544, 1.8365300348428844e-17},
+        {0.9807852804032304, 1.8546939997825006e-17},
+        {0.989176509964781, -4.098730993704711e-17},
+        {0.9951847266721969, -4.248691367830441e-17},
+        {0.9987954562051724, -1.2291693337075465e-17},
+        {1.0, 0.0}};
+
+    assert(n >= 0 && n <= 32);
+    return SIN_PI64[n];
+}
 
-    // Taylor series of the sin around 0
-    DDouble xsq = -x * x;
-    DDouble r = x;
-    DDouble xpow = x;
-    int i = 3;
-    for (; i <= n + 2; i += 2) {
-        xpow *= xsq;
-        r = r.add_small(reciprocal_factorial(i) * xpow);
+static DDouble reduce_pi64(DDouble x, int &n)
+{
+    // Reduce x to r = x - m pi/64, where m is the integer closest to
+    // x * 64/pi and n = m mod 128, with |r| <= pi/128 ~= 0.0245.  Instead
+    // of a division by pi/2, m is computed in double.  It may thus be off by
+    // one close to the midpoints, which only extends the range of r slightly.
+    const double INV_PI64 = 20.371832715762604;
+    double m = std::nearbyint(x.hi() * INV_PI64);
+    if (m == 0.0) {
+        n = 0;
+        return x;
     }
 
-    // Here the terms are so small that they only affect the lo part, so
-    // we can get away with double arithmetic.
-    double xsq_d = xsq.hi();
-    double xpow_d = xpow.hi();
-    double r_d = 0;
-    for (; i <= 2 * n + 1; i += 2) {
-        xpow_d *= xsq_d;
-        r_d += reciprocal_factorial(i).hi() * xpow_d;
+    // Subtract m pi/64, split into three parts.  The products of m with the
+    // first two parts are exact (Cody and Waite), so the cancellation with x
+    // is benign.  This is a problem for very large revolution count, where
+    // m pi/64 is not accurate enough, but there we have a problem anyway.
+    const double PI64_1 = 0.04908738521234052;
+    const double PI64_2 = 1.9135106236677394e-18;
+    const double PI64_3 = -4.6793278276849057e-35;
+    if (std::fabs(m) < 1e12) {
+        DDouble r = fma(-m, PI64_1, x);
+        r = fma(-m, PI64_2, r);
+        r -= m * PI64_3;
+
+        n = (int)std::fmod(m, 128.0);
+        if (n < 0)
+            n += 128;
+        return r;
     }
-    r = r.add_small(r_d);
+
+    // For large x, the rounding error of m in double exceeds the slack of
+    // the kernel, so we compute m in DDouble instead.  Once the precision of
+    // DDouble no longer resolves pi/64 in x (|x| > 1e28 or so), r is not
+    // within range after one step, but we reduce it again so that at least
+    // sin and cos stay within [-1, 1].  Close to overflow, we subtract a
+    // multiple of 256 pi/64 = 4 pi instead, which leaves n unchanged.
+    const DDouble INV_PI64_DD(INV_PI64, -1.259435307211679e-15);
+    const DDouble PI64_DD(PI64_1, PI64_2);
+    DDouble r = x;
+    double n_d = 0;
+    do {
+        bool huge = std::fabs(r.hi()) > 1e300;
+        PowerOfTwo scale = huge ? 256.0 : 1.0;
+        DDouble m_dd = round(r / scale * INV_PI64_DD);
+        r = fma(-m_dd, PI64_DD * scale, r);
+        r -= m_dd * (PI64_3 * scale);
+        if (!huge)
+            n_d += std::fmod(m_dd.hi(), 128.0) + std::fmod(m_dd.lo(), 128.0);
+    } while (std::fabs(r.hi()) > 0.0246);
+
+    n = (int)std::fmod(n_d, 128.0);
+    if (n < 0)
+        n += 128;
     return r;
 }
 
-static DDouble cos_kernel(DDouble x, int n = 13)
+static void sincos_kernel(DDouble x, DDouble &s, DDouble &cm1)
 {
-    // We need this to go out to pi/4 ~= 0.785
-    // Convergence of the Taylor approx to 2e-32
-    assert(n >= 0 && n <= 13);
+    // Taylor series of sin(x) = x (1 + t) and cos(x) = 1 + cm1 around 0,
+    // sharing the powers of xsq.  For |x| <= pi/128 (plus a bit), the terms
+    // beyond xsq^3 are so small that they only affect the lo part, and six
+    // terms converge to 2e-32.  Since |t|, |cm1| < 4e-4, their errors only
+    // weakly affect the result.
+    assert(std::fabs(x.hi()) <= 0.025);
 
-    // Taylor series of the cos around 0
     DDouble xsq = -x * x;
     DDouble xpow = xsq;
-    DDouble r = ExDouble(1.0).add_small(PowerOfTwo(0.5) * xpow);
+    Accumulator t, c;
+    t.add_product(reciprocal_factorial(3), xpow);
+    c += PowerOfTwo(0.5) * xpow;
     int i = 4;
-    for (; i <= n + 3; i += 2) {
+    for (; i <= 6; i += 2) {
         xpow *= xsq;
-        r = r.add_small(reciprocal_factorial(i) * xpow);
+        t.add_product(reciprocal_factorial(i + 1), xpow);
+        c.add_product(reciprocal_factorial(i), xpow);
     }
 
-    // Here the terms are so small that they only affect the lo part, so
-    // we can get away with double arithmetic.
+    // Here we can get away with double arithmetic.
     double xsq_d = xsq.hi();
     double xpow_d = xpow.hi();
-    double r_d = 0;
-    for (; i <= 2 * n; i += 2) {
+    double t_d = 0, c_d = 0;
+    for (; i <= 12; i += 2) {
         xpow_d *= xsq_d;
-        r_d += reciprocal_factorial(i).hi() * xpow_d;
+        t_d += reciprocal_factorial(i + 1).hi() * xpow_d;
+        c_d += reciprocal_factorial(i).hi() * xpow_d;
     }
-    r = r.add_small(r_d);
-    return r;
+    t += t_d;
+    c += c_d;
+    s = fma(x, t.value(), x);
+    cm1 = c.value();
 }
 
-static DDouble remainder_pi2(DDouble x, int &sector)
+static void sincos_impl(DDouble x, DDouble *s, DDouble *c)
 {
-    // This reduction has to be done quite carefully, because of the
-    // remainder.
-    using xprec::numbers::pi_half;
-    DDouble n = x / pi_half;
-    if (std::fabs(n.hi()) < 0.5) {
-        sector = 0;
-        return x;
+    // Special values
+    if (!isfinite(x)) {
+        if (s)
+            *s = NAN;
+        if (c)
+            *c = NAN;
+        return;
     }
 
-    // This is a problem for very large revolution count, but there we
-    // have a problem anyway.
-    n = round(n);
-    int64_t n_int = n.as<int64_t>();
-    sector = n_int % 4;
-    if (sector < 0)
-        sector += 4;
-    return x.add_small(-pi_half * n);
-}
-
-static DDouble sin_sector(DDouble x, int sector)
-{
-    using xprec::numbers::pi_4;
-    assert(sector >= 0 && sector < 4);
-    assert(std::fabs(x.hi()) <= std::nextafter(pi_4.hi(), INFINITY));
+    // Reduce x = (32 q + k) pi/64 + r and evaluate the kernel for r
+    int n;
+    DDouble r = reduce_pi64(x, n);
+    DDouble sr, cm1r;
+    sincos_kernel(r, sr, cm1r);
+
+    // Recombine sin(a + r) and cos(a + r) with a = k pi/64 using the angle
+    // addition formulas.  For k != 0, sin(a) and cos(a) dominate, and the
+    // corrections are small, so their rounding errors hardly matter.
+    // Only the ones needed after the rotation below are computed.
+    int q = n / 32, k = n % 32;
+    bool need_sa = q % 2 == 0 ? s != nullptr : c != nullptr;
+    bool need_ca = q % 2 == 0 ? c != nullptr : s != nullptr;
+    DDouble sa = 0.0, ca = 0.0;
+    if (k == 0) {
+        sa = sr;
+        if (need_ca)
+            ca = cm1r + 1.0;
+    } else {
+        DDouble sin_a = sin_pi64(k), cos_a = sin_pi64(32 - k);
+        if (need_sa) {
+            Accumulator acc(sin_a);
+            acc.add_product(cos_a, sr);
+            acc.add_product(sin_a, cm1r);
+            sa = acc.value();
+        }
+        if (need_ca) {
+            Accumulator acc(cos_a);
+            acc.add_product(cos_a, cm1r);
+            acc.add_product(-sin_a, sr);
+            ca = acc.value();
+        }
+    }
 
-    switch (sector) {
+    // Rotate by q quarter turns: sin(x + pi/2) = cos(x), etc.
+    switch (q) {
     case 0:
-        return sin_kernel(x);
+        break;
     case 1:
-        // use sin(x) = cos(x - pi/2)
-        return cos_kernel(x);
+        std::swap(sa, ca);
+        ca = -ca;
+        break;
     case 2:
-        // use sin(x) = -sin(x - pi)
-        return -sin_kernel(x);
+        sa = -sa;
+        ca = -ca;
+        break;
     default:
-        return -cos_kernel(x);
+        std::swap(sa, ca);
+        sa = -sa;
+        break;
     }
+    if (s)
+        *s = sa;
+    if (c)
+        *c = ca;
 }
 
 XPREC_API_EXPORT
 DDouble sin(DDouble x)
 {
-    int sector;
-    x = remainder_pi2(x, sector);
-    return sin_sector(x, sector);
+    DDouble s;
+    sincos_impl(x, &s, nullptr);
+    return s;
 }
 
 XPREC_API_EXPORT
 DDouble cos(DDouble x)
 {
-    // For small values, we shall use the cosine directly
-    using xprec::numbers::pi_4;
-    if (std::fabs(x.hi()) < pi_4.hi())
-        return cos_kernel(x);
-
-    // Otherwise, use common code.
-    int sector;
-    x = remainder_pi2(x, sector);
-    return sin_sector(x, (sector + 1) % 4);
+    DDouble c;
+    sincos_impl(x, nullptr, &c);
+    return c;
 }
 
 XPREC_API_EXPORT
 void sincos(DDouble x, DDouble &s, DDouble &c)
 {
-    // XXX This should be improved
-    s = sin(x);
-    c = cos(x);
+    // Reduce only once and evaluate both series together
+    sincos_impl(x, &s, &c);
 }
 
 XPREC_API_EXPORT
@@ -218,49 +322,209 @@ DDouble acos(DDouble x)
     return y0;
 }
 
-XPREC_API_EXPORT
-DDouble atan(DDouble x)
+static DDouble atan_64th(int k)
 {
-    // For large values, use reflection formula
-    if (std::fabs(x.hi()) > 1.0) {
-        DDouble y = copysign(xprec::numbers::pi_half, x);
-        if (isfinite(x))
-            y -= atan(reciprocal(x));
-        return y;
-    }
+    // atan(k/64) for k = 0, ..., 64
+    static const DDouble ATAN_64TH[65] = {
+        {0.0, 0.0},
+        {0.015623728620476831, -4.913600136566304e-19},
+        {0.031239833430268277, -1.188442711587748e-18},
+        {0.046840712915969654, -1.655677442254952e-19},
+        {0.06241880999595735, -1.5490756308295046e-18},
+        {0.0779666338315423, 5.804551873143357e-18},
+        {0.09347678115858947, -6.2844725995420954e-18},
+        {0.10894195698986579, 6.8267122072409585e-18},
+        {0.12435499454676144, -3.1253241424539383e-18},
+        {0.13970887428916365, -2.9579864247315813e-18},
+        {0.15499674192394097, 9.585415594114324e-18},
+        {0.1702119252854744, -3.541164079802125e-18},
+        {0.18534794999569476, 4.180692268843079e-18},
+        {0.2003985538258785, 3.1399542871844493e-18},
+        {0.21535769969773805, 4.738160130078733e-19},
+        {0.23021958727684372, 1.2313404529142703e-17},
+        {0.24497866312686414, 1.0698755618734451e-17},
+        {0.2596296294082575, 1.9238754924615304e-17},
+        {0.2741674511196588, 8.261353575163773e-18},
+        {0.2885873618940774, -1.428369957377257e-17},
+        {0.3028848683749714, -1.1010827903001369e-17},
+        {0.31705575320914703, -1.893928924292642e-17},
+        {0.3310960767041321, -7.952610375793799e-18},
+        {0.34500217720710513, -2.2938804755578304e-17},
+        {0.35877067027057225, -2.4623815582638635e-17},
+        {0.3723984466767542, 1.9612311504845653e-17},
+        {0.38588266939807375, 2.378822732491941e-17},
+        {0.39922076957525254, 2.246598105617042e-17},
+        {0.4124104415973873, -1.587652227770689e-17},
+        {0.42544963737004227, 2.3315530741892885e-17},
+        {0.43833655985795783, -2.494277030626541e-17},
+        {0.4510696559885235, -2.2703795229420475e-17},
+        {0.4636476090008061, 2.2698777452961687e-17},
+        {0.4760693303227612, 1.4654487332256713e-17},
+        {0.48833395105640554, -1.1373236189329585e-17},
+        {0.5004408131472942, -4.7181675085518756e-17},
+        {0.5123894603107377, -2.5462781472855804e-17},
+        {0.5241796287829132, 5.520094119641666e-18},
+        {0.5358112379604637, -4.0637956834825575e-18},
+        {0.5472843809874369, 4.923709671396255e-17},
+        {0.5585993153435624, -5.4556305485916264e-18},
+        {0.5697564534829784, 1.2255062085054184e-17},
+        {0.5807563535676704, -1.441464378193067e-17},
+        {0.5915997103351114, 4.920495453686772e-17},
+        {0.6022873461349642, 2.950430737228402e-17},
+        {0.6128202021652414, -3.1552061848586226e-17},
+        {0.6231993299340659, 2.672403885140095e-17},
+        {0.6334258829691446, -2.7290767436015276e-17},
+        {0.6435011087932844, 1.5834785051444286e-17},
+        {0.6534263411807619, 3.5800634857340095e-17},
+        {0.6632029927060933, -3.076054864429649e-17},
+        {0.6728325475937632, -1.899315009714705e-17},
+        {0.6823165548747481, 6.943223671560008e-18},
+        {0.6916566218531999, -8.117151192285796e-18},
+        {0.7008544078844502, -1.987626234335816e-17},
+        {0.7099116184635249, -4.597166450584887e-17},
+        {0.7188299996216245, -2.1478388444456983e-17},
+        {0.7276113326265107, 2.569325697391839e-18},
+        {0.7362574289814281, 3.473937648299457e-17},
+        {0.7447701257160751, 3.708315849135547e-17},
+        {0.7531512809621944, -2.4256934659182068e-17},
+        {0.7614027698055784, 9.850030332752822e-18},
+        {0.7695264804056583, -3.704991905602721e-17},
+        {0.7775243103733478, -2.6676490951944502e-17},
+        {0.7853981633974483, 3.061616997868383e-17}};
+
+    assert(k >= 0 && k <= 64);
+    return ATAN_64TH[k];
+}
 
-    // Again use Taylor expansion
-    DDouble y0 = std::atan(x.hi());
-    if (!isfinite(y0))
-        return y0;
+static DDouble atan_kernel(DDouble r)
+{
+    // Series of atan(r) = r (1 + t) around 0, where
+    //
+    //   t = -r^2/3 + r^4/5 - r^6/7 + ...
+    //
+    // For |r| <= 1/128 (plus a bit), the terms beyond r^6 only affect the lo
+    // part, and seven terms converge to 2e-32.  Since |t| < 3e-5, its errors
+    // only weakly affect the result.
+    assert(std::fabs(r.hi()) <= 0.0079);
+    const DDouble ONE_THIRD(0.3333333333333333, 1.850371707708594e-17);
+    const DDouble ONE_FIFTH(0.2, -1.1102230246251566e-17);
+    const DDouble ONE_SEVENTH(0.14285714285714285, 7.93016446160826e-18);
+
+    DDouble rsq = -r * r;
+    DDouble rpow = rsq;
+    Accumulator t;
+    t.add_product(ONE_THIRD, rpow);
+    rpow *= rsq;
+    t.add_product(ONE_FIFTH, rpow);
+    rpow *= rsq;
+    t.add_product(ONE_SEVENTH, rpow);
+
+    // Here we can get away with double arithmetic.
+    double rsq_d = rsq.hi();
+    double t_d = 0.06666666666666667;
+    t_d = 0.07692307692307693 + t_d * rsq_d;
+    t_d = 0.09090909090909091 + t_d * rsq_d;
+    t_d = 0.1111111111111111 + t_d * rsq_d;
+    t += t_d * (rpow.hi() * rsq_d);
+    return fma(r, t.value(), r);
+}
 
-    DDouble s, c, x0;
+static DDouble atan_ratio(DDouble y, DDouble x)
+{
+    // Computes atan(y/x) for 0 <= y <= x, where x is positive and finite,
+    // using the addition formula:
+    //
+    //   atan(y/x) = atan(c) + atan(r),    r = (y - c x) / (x + c y)
+    //
+    // with c = k/64 the closest to y/x, such that |r| <= 1/128.  Since
+    // y - c x is small, it is formed by a fused multiply-add.  This way, only
+    // the reduced argument needs a division, rather than y/x.
+    int k = (int) (64 * (y.hi() / x.hi()) + 0.5);
+    if (k == 0)
+        return atan_kernel(y / x);
+
+    double c = k * 0.015625;
+    DDouble num = fma(x, -c, y);
+    DDouble den = fma(y, c, x);
+    return atan_64th(k) + atan_kernel(num / den);
+}
 
-    sincos(y0, s, c);
-    x0 = s / c;
-    y0 += (x - x0) * c * c;
+XPREC_API_EXPORT
+DDouble atan(DDouble x)
+{
+    using xprec::numbers::pi_half;
 
-    return y0;
+    // Special values
+    if (isnan(x))
+        return x;
+    if (isinf(x))
+        return copysign(pi_half, x);
+
+    // Small values are handled by the kernel directly.  For large values,
+    // we use the reflection formula atan(x) = pi/2 - atan(1/x), where the
+    // division is again left to the reduced argument.
+    DDouble ax = fabs(x);
+    DDouble res;
+    if (ax.hi() < 0.0078125)
+        return atan_kernel(x);
+    else if (ax.hi() > 1.0)
+        res = pi_half - atan_ratio(1.0, ax);
+    else
+        res = atan_ratio(ax, 1.0);
+    return copysign(res, x);
 }
 
 XPREC_API_EXPORT
 DDouble atan2(DDouble y, DDouble x)
 {
     using xprec::numbers::pi;
+    using xprec::numbers::pi_4;
     using xprec::numbers::pi_half;
 
     // Special values
     if (isnan(x) || isnan(y))
         return NAN;
+    if (isinf(x)) {
+        DDouble res;
+        if (isinf(y))
+            res = x.hi() > 0 ? pi_4 : pi - pi_4;
+        else
+            res = x.hi() > 0 ? 0.0 : pi;
+        return copysign(res, y);
+    }
+    if (isinf(y))
+        return copysign(pi_half, y);
     if (iszero(y))
         return x.hi() >= 0 ? 0.0 : pi;
     if (iszero(x))
         return copysign(pi_half, y);
 
-    DDouble res = atan(y / x);
+    // Reduce to the first octant, 0 < |y| <= |x|, by the symmetries
+    //
+    //   atan2(y, x) = pi/2 - atan2(x, y) = pi - atan2(y, -x) = -atan2(-y, x)
+    //
+    DDouble ax = fabs(x), ay = fabs(y);
+    bool swapped = ay > ax;
+    if (swapped)
+        std::swap(ax, ay);
+
+    // Scale both, such that the products and quotients of the reduction
+    // neither overflow nor lose their lo parts to underflow.
+    const double TWO_POW_200 = 1.6069380442589903e+60;
+    if (ax.hi() > 1e290) {
+        ax /= PowerOfTwo(TWO_POW_200);
+        ay /= PowerOfTwo(TWO_POW_200);
+    } else if (ax.hi() < 1e-290) {
+        ax *= PowerOfTwo(TWO_POW_200);
+        ay *= PowerOfTwo(TWO_POW_200);
+    }
+
+    DDouble res = atan_ratio(ay, ax);
+    if (swapped)
+        res = pi_half - res;
     if (x.hi() < 0)
-        res = copysign(pi, y).add_small(res);
-    return res;
+        res = pi - res;
+    return copysign(res, y);
 }
 
 } // namespace xprec
@@ -8,7 +8,9 @@
  * and also licensed MIT
  */
 #include "taylor.hpp"
+#include "xprec/accumulator.hpp"
 #include "xprec/ddouble.hpp"
+#include "xprec/internal/utils.hpp"
 #include <cassert>
 
 #ifndef XPREC_API_EXPORT
@@ -21,11 +23,12 @@ inline DDouble expm1_kernel_taylor(DDouble x, int n)
 {
     assert(std::fabs(x.hi()) < 1.0);
     DDouble xpow = x * x;
-    DDouble r = x.add_small(PowerOfTwo(0.5) * xpow);
+    Accumulator r = x;
+    r += PowerOfTwo(0.5) * xpow;
     int k = 3;
     for (; k <= n / 2 + 1; ++k) {
         xpow *= x;
-        r = r.add_small(reciprocal_factorial(k) * xpow);
+        r.add_product(reciprocal_factorial(k), xpow);
     }
 
     // Here the terms are so small that they only affect the lo part, so
@@ -36,8 +39,8 @@ inline DDouble expm1_kernel_taylor(DDouble x, int n)
         xpow_d *= x.hi();
         r_d += reciprocal_factorial(k).hi() * xpow_d;
     }
-    r = r.add_small(r_d);
-    return r;
+    r += r_d;
+    return r.value();
 }
 
 static DDouble expm1_128th(int n)
@@ -136,124 +139,298 @@ static DDouble expm1_quarter(DDouble x)
     return expm1_x0.add_small(exp_x0 * exp_y);
 }
 
-class Product {
-public:
-    constexpr Product() : _isempty(true), _res(1) { }
-
-    template <typename T>
-    Product &operator*=(const T &x)
-    {
-        if (_isempty)
-            _res = x;
-        else
-            _res *= x;
-
-        _isempty = false;
-        return *this;
-    }
-
-    constexpr operator DDouble() const { return _res; }
-
-private:
-    bool _isempty;
-    DDouble _res;
-};
-
-static DDouble exp_halves(int x)
+static DDouble exp2_256th(int j)
 {
-    const static DDouble EXP_HALVES[31] = {
-        {1.6487212707001282, -4.731568479435833e-17},
-        {2.718281828459045, 1.4456468917292502e-16},
-        {4.4816890703380645, 3.0481759556536343e-16},
-        {7.38905609893065, -1.7971139497839148e-16},
-        {12.182493960703473, 2.0334002173348147e-16},
-        {20.085536923187668, -1.8275625525512858e-16},
-        {33.11545195869231, 2.2435601403927554e-15},
-        {54.598150033144236, 2.8741578015844115e-15},
-        {90.01713130052181, 2.550844346114049e-15},
-        {148.4131591025766, 3.4863514900464198e-15},
-        {244.69193226422038, 4.129320187450839e-15},
-        {403.4287934927351, 1.2359628024450387e-14},
-        {665.1416330443618, 2.990469256473133e-14},
-        {1096.6331584284585, 9.869752640434095e-14},
-        {1808.0424144560632, 3.6612201665204784e-14},
-        {2980.9579870417283, -2.7103295816873633e-14},
-        {4914.768840299134, 2.17317454126359e-14},
-        {8103.083927575384, -2.1530877621067177e-13},
-        {13359.726829661873, -8.496858340658619e-13},
-        {22026.465794806718, -1.3780134700517372e-12},
-        {36315.502674246636, 1.577797006387782e-12},
-        {59874.14171519782, 1.7895764888916994e-12},
-        {98715.7710107605, 3.036676373480473e-12},
-        {162754.79141900392, 5.30065881322063e-12},
-        {268337.2865208745, -2.0035114163950887e-11},
-        {442413.3920089205, 1.2118711752313224e-11},
-        {729416.3698477013, 5.1483277361034595e-11},
-        {1.2026042841647768e6, -1.5000525764327354e-11},
-        {1.9827592635375687e6, 2.845770459793355e-11},
-        {3.2690173724721107e6, -3.075806431120808e-11},
-        {5.389698476283012e6, 4.098121666636582e-10}};
-    const static DDouble EXP_SIXTEENS[44] = {
-        {8.886110520507872e6, 5.321182483501564e-10},
-        {7.896296018268069e13, 0.007660978022635108},
-        {7.016735912097631e20, 30185.471599886117},
-        {6.235149080811617e27, 1.3899738872492847e11},
-        {5.54062238439351e34, 2.1811937023229343e18},
-        {4.923458286012058e41, 1.3869835129739753e25},
-        {4.375039447261341e48, 1.035824156236645e32},
-        {3.887708405994595e55, 2.707966110366217e39},
-        {3.454660656717546e62, 1.8553902103629043e46},
-        {3.0698496406442424e69, 4.375620509828095e52},
-        {2.7279023188106115e76, 6.6492459414351406e59},
-        {2.4240441494100796e83, -3.8332753349400205e66},
-        {2.1540324218248465e90, 6.568050851363196e73},
-        {1.9140970165092822e97, -1.497464557916617e81},
-        {1.700887763567586e104, 1.4773861394382237e88},
-        {1.5114276650041035e111, 1.4805989167614457e94},
-        {1.3430713274979614e118, -6.561438244448466e101},
-        {1.1934680253072109e125, -3.301231394418859e108},
-        {1.0605288775572162e132, 5.4744408887427266e115},
-        {9.423976816163585e138, -2.7555072985830676e122},
-        {8.374249953113352e145, -3.529195534423469e129},
-        {7.441451060972311e152, 4.251237045552673e136},
-        {6.612555656075053e159, -3.4828210031110127e143},
-        {5.875990038289236e166, 7.682543674132907e149},
-        {5.221469689764144e173, -3.041154182825333e157},
-        {4.639855674272614e180, -3.3453058659461497e164},
-        {4.123027032079202e187, 1.8602059512155307e171},
-        {3.663767388609735e194, -1.8555200045340274e178},
-        {3.255664193661862e201, 5.148254191579011e184},
-        {2.8930191842539453e208, -2.8880381060655904e191},
-        {2.5707688209230085e215, 1.1853726094570251e199},
-        {2.2844135865397565e222, 1.3549224944023444e206},
-        {2.0299551604542052e229, 1.2942147572086164e213},
-        {1.803840590747136e236, 1.820681001928355e218},
-        {1.6029126850757262e243, -2.463627227554342e226},
-        {1.4243659274306933e250, -5.204358467973364e233},
-        {1.2657073052794837e257, -3.983584155610672e240},
-        {1.124721500132769e264, -8.843155706148207e247},
-        {9.994399554971195e270, 8.925025806205413e253},
-        {8.881133903158874e277, -4.948247489077345e261},
-        {7.891873741089921e284, 2.4630459641303726e268},
-        {7.012806227721897e291, -1.1759583274063904e275},
-        {6.231657119844268e298, 1.1619020533730335e281},
-        {5.5375193892845935e305, 1.5239358093004245e289}};
-
-    if (x < 0) {
-        return reciprocal(exp_halves(-x));
-    }
-    assert(x <= 1439);
-
-    Product res;
-    int x_halves = x % 32;
-    if (x_halves)
-        res *= EXP_HALVES[x_halves - 1];
-
-    int x_sixteens = x / 32;
-    if (x_sixteens)
-        res *= EXP_SIXTEENS[x_sixteens - 1];
+    static const DDouble EXP2_256TH[256] = {
+        {1.0, 0.0},
+        {1.0027112750502025, -3.636615928692264e-17},
+        {1.0054299011128027, 9.499186535455032e-17},
+        {1.0081558981184175, -3.252058756084308e-17},
+        {1.0108892860517005, -1.5234778603368577e-17},
+        {1.0136300849514894, 9.283599768183568e-18},
+        {1.016378314910953, -5.77217007319966e-17},
+        {1.019133996077738, 3.601904982259662e-17},
+        {1.0218971486541166, 5.109225028973444e-17},
+        {1.0246677928971357, -7.56160786848778e-17},
+        {1.0274459491187637, -4.9560741746453704e-17},
+        {1.030231637686041, 3.319830041080813e-17},
+        {1.0330248790212284, 7.600838874027088e-18},
+        {1.0358256936019572, -7.806782391337636e-17},
+        {1.0386341019613787, 5.996273788852511e-17},
+        {1.041450124688316, 3.784830480287576e-17},
+        {1.0442737824274138, 8.551889705537965e-17},
+        {1.0471050958792898, 7.277077243104315e-17},
+        {1.0499440858006872, 5.592937848127003e-17},
+        {1.0527907730046264, -9.629482899026936e-17},
+        {1.0556451783605572, 1.759325738772092e-18},
+        {1.0585073227945128, -7.152651856637781e-17},
+        {1.061377227289262, -1.1973537085365658e-17},
+        {1.0642549128844645, 5.0787541986112304e-17},
+        {1.0671404006768237, -7.899853966841582e-17},
+        {1.0700337118202419, -9.937162711288919e-17},
+        {1.0729348675259756, -3.839668843358824e-18},
+        {1.075843889062791, -1.0002716151144136e-17},
+        {1.0787607977571199, -6.656660436056593e-17},
+        {1.0816856149932152, -4.782623902997086e-17},
+        {1.0846183622133092, 3.166152845816346e-17},
+        {1.0875590609177697, 5.409349307820291e-18},
+        {1.0905077326652577, -3.046782079812471e-17},
+        {1.0934643990728858, 1.441395814726921e-17},
+        {1.0964290818163769, -5.919933484449316e-17},
+        {1.099401802630222, 7.170459599701923e-17},
+        {1.102382583307841, 5.2660368715706944e-17},
+        {1.1053714457017412, 8.239288760500214e-17},
+        {1.1083684117236787, -8.786813845180527e-17},
+        {1.1113735033448175, 5.563945026669698e-17},
+        {1.1143867425958924, 1.0410278456845571e-16},
+        {1.1174081515673693, -7.97680590262822e-17},
+        {1.1204377524096067, -6.201085906554179e-17},
+        {1.12347556733302, -9.699737588987043e-17},
+        {1.1265216186082418, 5.165856758795457e-17},
+        {1.129575928566288, 6.712805858726257e-17},
+        {1.1326385195987192, 3.237356166738e-17},
+        {1.1357094141578055, 5.066599926126156e-17},
+        {1.1387886347566916, 8.912812676025408e-17},
+        {1.1418762039695616, 4.6510911775314124e-17},
+        {1.1449721444318042, 4.6412898921700107e-17},
+        {1.148076478840179, 6.897740236627192e-17},
+        {1.1511892299529827, 3.250710218863827e-17},
+        {1.154310420590216, 1.0417128946273266e-16},
+        {1.1574400736337511, -9.1238712311344e-17},
+        {1.1605782120274988, -3.261040205417394e-17},
+        {1.1637248587775775, 3.8292048369240935e-17},
+        {1.1668800369524817, -8.79187957999917e-17},
+        {1.1700437696832502, -1.8477442017900047e-18},
+        {1.1732160801636373, -7.287562586584994e-17},
+        {1.1763969916502812, 5.554203254218079e-17},
+        {1.1795865274628758, 1.009231277510039e-16},
+        {1.182784710984341, 1.542975430079076e-17},
+        {1.1859915656609938, -9.209506835293106e-18},
+        {1.189207115002721, 3.982015231465646e-17},
+        {1.1924313825831512, 4.3975514156097214e-17},
+        {1.1956643920398273, 4.6166036704814814e-17},
+        {1.1989061670743806, -9.809193356008423e-17},
+        {1.202156731452703, 6.644981499252301e-17},
+        {1.2054161090051239, -3.3572721932675296e-17},
+        {1.2086843236265816, -4.746725945228984e-17},
+        {1.2119613992768012, -4.8906110775211184e-17},
+        {1.215247359980469, -7.712630692681488e-17},
+        {1.2185422298274085, -9.006726958363838e-17},
+        {1.2218460329727576, -1.0611021211402691e-16},
+        {1.2251587936371455, -8.903533814269983e-17},
+        {1.22848053610687, -1.89878163130253e-17},
+        {1.2318112847340759, 7.38938247161005e-17},
+        {1.2351510639369334, -1.0755244344307841e-16},
+        {1.2384998981998165, 2.7677020555739674e-17},
+        {1.241857812073484, 4.658027591836937e-17},
+        {1.245224830175258, -4.6772404498467275e-17},
+        {1.2486009771892048, -8.261810999021964e-17},
+        {1.2519862778663162, 4.8341671524698976e-17},
+        {1.255380757024691, -6.7113898212968784e-18},
+        {1.2587844395497165, -8.421782587730599e-17},
+        {1.2621973503942507, -3.0844648874738465e-17},
+        {1.2656195145788063, 4.2505770034508686e-17},
+        {1.2690509571917332, 2.667932131342186e-18},
+        {1.2724917033894028, -1.0577916267212421e-17},
+        {1.275941778396392, 9.91543024421429e-17},
+        {1.2794012075056693, -9.759095008356062e-17},
+        {1.2828700160787783, 1.713594918243561e-17},
+        {1.2863482295460256, -3.416955706936182e-17},
+        {1.2898358734066657, 8.949257530897592e-17},
+        {1.2933329732290895, -2.9745904431327516e-17},
+        {1.2968395546510096, 2.5382502794888315e-17},
+        {1.3003556433796506, 5.678728102802217e-17},
+        {1.3038812651919358, 8.647675598267871e-17},
+        {1.3074164459346773, -7.336645652878869e-17},
+        {1.3109612115247644, -7.181536135519454e-17},
+        {1.3145155879493546, 2.2675433151045856e-17},
+        {1.318079601266064, -5.4579558271491535e-17},
+        {1.3216532776031575, -2.4806382459130217e-17},
+        {1.3252366431597413, -2.8587312100388614e-17},
+        {1.3288297242059544, 4.08908622391016e-17},
+        {1.3324325470831615, -5.101586630916744e-17},
+        {1.3360451382041458, -5.891866356388801e-17},
+        {1.339667524053303, 8.927282594831732e-17},
+        {1.3432997311868353, -5.802580890201438e-17},
+        {1.3469417862329458, 3.224065101254679e-17},
+        {1.3505937158920345, -8.287110381462417e-17},
+        {1.3542555469368927, 7.70094837980299e-17},
+        {1.3579273062129011, -9.529635744825189e-17},
+        {1.3616090206382248, 1.533787661270668e-18},
+        {1.365300717204012, -1.0005363125974765e-16},
+        {1.3690024229745905, 9.593797919118849e-17},
+        {1.3727141650876684, -4.495960595234841e-17},
+        {1.3764359707545302, -6.898588935871801e-17},
+        {1.380167867260238, 1.0510314579969984e-16},
+        {1.383909881963832, -6.770511658794786e-17},
+        {1.387662042298529, 8.422984274875415e-17},
+        {1.3914243757719262, -4.9061748652889893e-17},
+        {1.3951969099662003, -9.329336224225497e-17},
+        {1.3989796725383112, -9.614213209051323e-17},
+        {1.4027726912202048, -5.295783249407989e-17},
+        {1.4065759938190154, 7.034914812136422e-18},
+        {1.4103896082172707, 4.166548728435062e-17},
+        {1.4142135623730951, -9.667293313452913e-17},
+        {1.4180478843204152, 2.2744385421855295e-17},
+        {1.4218926021691656, -1.6077828915890244e-17},
+        {1.4257477441054942, 9.880690758500607e-17},
+        {1.42961333839197, -1.2031642489053655e-17},
+        {1.433489413367789, -5.802454243926826e-17},
+        {1.4373759974489824, -4.2040340164675566e-17},
+        {1.4412731191286257, 5.602503650878986e-18},
+        {1.4451808069770467, -3.0237581349939873e-17},
+        {1.449099089642035, -6.259405000819309e-17},
+        {1.4530279958490526, -5.779948609396106e-17},
+        {1.4569675544014438, 5.648679453876998e-17},
+        {1.460917794180647, -5.600377186075216e-17},
+        {1.4648787441464057, 9.530767543587157e-17},
+        {1.4688504333369818, 8.465882756533628e-17},
+        {1.4728328908693675, 6.691774081940589e-17},
+        {1.4768261459394993, -3.483994556892796e-17},
+        {1.4808302278224719, -9.686952102630619e-17},
+        {1.4848451658727524, 1.0780086764407481e-16},
+        {1.488870989524397, 6.155367157742871e-17},
+        {1.4929077282912648, 1.4192920154284036e-17},
+        {1.4969554117672355, -2.861663253899158e-17},
+        {1.5010140696264256, -6.413767275790235e-17},
+        {1.5050837316234065, 7.074710613582846e-17},
+        {1.5091644275934228, -1.016455327754295e-16},
+        {1.5132561874526098, 8.884497851338712e-17},
+        {1.5173590411982147, -4.308699472043341e-17},
+        {1.5214730189088146, -5.9963876759456834e-18},
+        {1.5255981507445384, -1.1024941712342561e-16},
+        {1.529734466947287, 3.7857921151572197e-17},
+        {1.533881997840956, 8.875226844438446e-17},
+        {1.5380407738316568, 1.0174672351161359e-16},
+        {1.5422108254079407, 7.949834809697621e-17},
+        {1.5463921831410214, 1.068396000565722e-16},
+        {1.550584877685, -1.4600706590689385e-17},
+        {1.5547889397770887, -8.003161350116036e-17},
+        {1.559004400237837, 3.7812070533575275e-17},
+        {1.5632312899713576, 7.484777645590734e-17},
+        {1.567469639965553, -1.0352061768849722e-16},
+        {1.5717194812923414, -3.3429840046872e-17},
+        {1.5759808451078865, -1.0136916471278304e-17},
+        {1.5802537626528246, -5.163402929554468e-17},
+        {1.5845382652524937, -1.9337717034585703e-17},
+        {1.588834384317164, -5.9949501188244794e-18},
+        {1.593142151342267, -1.0094406542311964e-16},
+        {1.597461597908627, 2.4868392796221e-17},
+        {1.6017927556826934, -6.054917453527784e-17},
+        {1.606135656416771, -1.0354545288059995e-16},
+        {1.6104903319492543, 2.4707192569797888e-17},
+        {1.6148568142048607, -7.316663399125123e-17},
+        {1.6192351351948637, 2.0941334154229092e-17},
+        {1.6236253270173289, -3.584512851414475e-17},
+        {1.6280274218573478, -6.712955084707084e-17},
+        {1.632441451987275, 9.852819230429993e-17},
+        {1.6368674497669644, 7.698325071319876e-17},
+        {1.6413054476440063, -9.247568737640706e-17},
+        {1.645755478153965, -1.0125679913674773e-16},
+        {1.6502175739206177, 9.133279588729904e-18},
+        {1.6546917676561943, 9.643294303196029e-17},
+        {1.6591780921616162, -7.275545550823051e-17},
+        {1.6636765803267364, 5.8909926967131e-17},
+        {1.6681872651305825, 4.269178019570615e-17},
+        {1.6727101796415966, -5.476715964599563e-17},
+        {1.6772453570178785, 8.303949509950733e-17},
+        {1.681792830507429, 8.199010020581497e-17},
+        {1.6863526334483934, -7.181463278358011e-17},
+        {1.6909247992693053, -9.66967147439488e-17},
+        {1.6955093614893326, 7.238416872845167e-17},
+        {1.7001063537185235, -8.0237193703977e-18},
+        {1.7047158096580513, -2.7288832847972816e-17},
+        {1.709337763100463, -9.868779456632931e-17},
+        {1.713972247929926, 6.473975107753367e-17},
+        {1.718619298122478, -1.851380418263111e-17},
+        {1.723278947746274, -9.5221238003938e-17},
+        {1.7279512309618377, -1.0750981861204642e-16},
+        {1.732636182022311, -1.6980510743154155e-18},
+        {1.7373338352737062, 3.164389299292957e-17},
+        {1.7420442251551564, -1.5259591189507888e-18},
+        {1.746767386199169, -1.0752290483507515e-16},
+        {1.7515033530318782, -5.1244504205967247e-17},
+        {1.7562521603732995, 2.960140695448873e-17},
+        {1.761013843037584, -7.943253125039228e-17},
+        {1.7657884359332727, 9.461315018083268e-17},
+        {1.7705759740635547, 5.961794510040556e-17},
+        {1.7753764925265212, 6.429731796556572e-17},
+        {1.7801900265154245, -5.2846272890916174e-17},
+        {1.785016611318935, 1.5330400121031314e-17},
+        {1.789856282321401, -4.1543546606833504e-17},
+        {1.7947090750031072, 1.8227458427912087e-17},
+        {1.7995750249405351, -2.526889233358898e-17},
+        {1.804454167806624, -5.177222408793318e-17},
+        {1.809346539371032, -9.03264140245003e-17},
+        {1.8142521755003989, -9.969531538920349e-17},
+        {1.8191711121586085, 7.402676901145839e-17},
+        {1.8241033854070534, -1.0159627862277083e-16},
+        {1.8290490314048973, 6.889192908835696e-17},
+        {1.8340080864093424, 3.283107224245627e-17},
+        {1.8389805867758937, 6.918969740272512e-18},
+        {1.843966568958626, -5.939742026949965e-17},
+        {1.8489660695104508, 9.027580446261089e-17},
+        {1.8539791250833855, 9.761887490727594e-17},
+        {1.8590057724288205, -9.528705461989941e-17},
+        {1.864046048397789, 6.540912680620572e-17},
+        {1.8690999899412386, -9.938505214255067e-17},
+        {1.8741676341103, -6.122763413004143e-17},
+        {1.8792490180565602, -1.6226315557835845e-17},
+        {1.8843441790323345, -8.226593125533711e-17},
+        {1.8894531543909392, -9.005168285059127e-17},
+        {1.8945759815869656, 3.4034035352165297e-17},
+        {1.8997126981765553, -3.8597397693785143e-17},
+        {1.9048633418176741, 6.533857514718279e-17},
+        {1.9100279502703899, -5.90968800674406e-17},
+        {1.9152065613971474, -1.0619946056195963e-16},
+        {1.9203992131630474, 7.116681540630314e-17},
+        {1.925605943636125, -9.914963769693741e-17},
+        {1.930826790987627, 6.16714970616911e-17},
+        {1.9360617934922943, 1.0332385960676326e-16},
+        {1.9413109895286405, -6.638029891621488e-17},
+        {1.9465744175792332, 6.811022349533877e-17},
+        {1.9518521162309783, -2.199016969979351e-17},
+        {1.9571441241754002, 8.960767791036668e-17},
+        {1.9624504802089273, 1.0976844000913547e-16},
+        {1.9677712232331759, -1.0314928011531132e-16},
+        {1.9731063922552343, -7.451617863956037e-18},
+        {1.978456026387951, 4.0388753109278167e-17},
+        {1.9838201648502194, -2.2034544123910627e-17},
+        {1.9891988469672663, 8.2051326383692e-18},
+        {1.9945921121709402, 1.7909710352002645e-17}};
+
+    assert(j >= 0 && j < 256);
+    return EXP2_256TH[j];
+}
 
-    return res;
+static DDouble expm1_reduced(DDouble x, int &k, DDouble &t)
+{
+    // Reduce x to r = x - n log(2)/256, where n is the integer closest to
+    // x * 256/log(2), such that |r| <= log(2)/512 ~= 0.00135.  Writing
+    // n = 256 k + j with 0 <= j < 256, we then have:
+    //
+    //   exp(x) = 2^k t (1 + expm1(r)),     t = 2^(j/256)
+    //
+    // This sets k and t and returns expm1(r).
+    const double INV_LN2_256 = 369.3299304675746;
+    double n = std::nearbyint(x.hi() * INV_LN2_256);
+
+    // Subtract n log(2)/256, split into three parts.  The products of n with
+    // the first two parts are exact (Cody and Waite), and so is the
+    // cancellation with x.hi, so r is as accurate as the remaining additions.
+    const double LN2_256_1 = 0.002707606173999011;
+    const double LN2_256_2 = 6.327543041506426e-14;
+    const double LN2_256_3 = 1.5629239639119998e-24;
+    DDouble r = ExDouble(x.hi() - n * LN2_256_1) + x.lo();
+    r -= n * LN2_256_2;
+    r -= n * LN2_256_3;
+
+    int j = (int)n % 256;
+    if (j < 0)
+        j += 256;
+    k = ((int)n - j) / 256;
+    t = exp2_256th(j);
+    return expm1_kernel_taylor(r, 9);
 }
 
 XPREC_API_EXPORT
@@ -261,19 +438,31 @@ DDouble exp(DDouble x)
 {
     if (isnan(x))
         return x;
-    if (x.hi() >= 709.0)
+    if (x.hi() > 709.782712893384)
         return DDouble(INFINITY, 0);
-    if (x.hi() <= -709.0)
+    if (x.hi() < -745.1332191019412)
         return DDouble(0);
 
-    // x = y/2 + z
-    double y = std::round(2 * x.hi());
-    DDouble z = x - y / 2;
+    // exp(r) is close to one, so the rounding errors of the product with
+    // expm1(r) hardly matter.
+    int k;
+    DDouble t;
+    DDouble expm1_r = expm1_reduced(x, k, t);
+    DDouble res = t.add_small(t * expm1_r);
+
+    // Apply 2^k, which is exact unless the result is subnormal.  Close to
+    // overflow or underflow, 2^k itself is not a normal number, so we
+    // scale in two steps.
+    if (k < -1022 || k > 1023) {
+        res *= _internal::normal_power_of_two(k / 2);
+        k -= k / 2;
+    }
+    res *= _internal::normal_power_of_two(k);
 
-    // exp(z + y/2) = (1 + expm1(z)) exp(1/2)^y
-    DDouble exp_z = ExDouble(1.0).add_small(expm1_quarter(z));
-    DDouble exp_y = exp_halves(int(y));
-    return exp_z * exp_y;
+    // Right at the threshold, the hi part may still overflow.
+    if (!_internal::is_finite(res.hi()))
+        return DDouble(INFINITY, 0);
+    return res;
 }
 
 XPREC_API_EXPORT
@@ -283,50 +472,365 @@ DDouble expm1(DDouble x)
     if (std::fabs(x.hi()) < 0.25)
         return expm1_quarter(x);
 
-    // Otherwise, we do a naive computation
-    DDouble res = exp(x);
-    if (x.hi() < 75)
-        res -= 1.0;
-    return res;
+    // For large values, exp(x) dominates, and for very negative values,
+    // the subtraction is benign.  This also handles infinities and NaN.
+    if (!(x.hi() > -40 && x.hi() < 75)) {
+        DDouble res = exp(x);
+        if (x.hi() < 75)
+            res -= 1.0;
+        return res;
+    }
+
+    // Otherwise, we subtract one before adding the correction:
+    //
+    //   expm1(x) = (2^k t - 1) + 2^k t expm1(r)
+    //
+    // Since |x| >= 1/4, the first term dominates.
+    int k;
+    DDouble t;
+    DDouble expm1_r = expm1_reduced(x, k, t);
+    t *= _internal::normal_power_of_two(k);
+    return (t - 1.0) + t * expm1_r;
 }
 
-XPREC_API_EXPORT
-DDouble log(DDouble x)
+static DDouble log_128th(int k, double &r, double *tail)
+{
+    // RECIP_128TH[k + 37] is 1/(1 + k/128) rounded to double, and
+    // LOG_128TH[k + 37] is -log of that double, i.e., log(1 + k/128) up to
+    // the rounding of the reciprocal.  If tail is given, the next term
+    // of the logarithm from LOG_128TH_TAIL is added to it.
+    static const double RECIP_128TH[91] = {
+        1.4065934065934067, 1.391304347826087, 1.3763440860215055,
+        1.3617021276595744, 1.3473684210526315, 1.3333333333333333,
+        1.3195876288659794, 1.3061224489795917, 1.292929292929293,
+        1.28, 1.2673267326732673, 1.2549019607843137,
+        1.2427184466019416, 1.2307692307692308, 1.2190476190476192,
+        1.2075471698113207, 1.1962616822429906, 1.1851851851851851,
+        1.1743119266055047, 1.1636363636363636, 1.1531531531531531,
+        1.1428571428571428, 1.1327433628318584, 1.1228070175438596,
+        1.1130434782608696, 1.103448275862069, 1.0940170940170941,
+        1.0847457627118644, 1.0756302521008403, 1.0666666666666667,
+        1.0578512396694215, 1.0491803278688525, 1.0406504065040652,
+        1.032258064516129, 1.024, 1.0158730158730158,
+        1.0078740157480315, 1.0, 0.9922480620155039,
+        0.9846153846153847, 0.9770992366412213, 0.9696969696969697,
+        0.9624060150375939, 0.9552238805970149, 0.9481481481481482,
+        0.9411764705882353, 0.9343065693430657, 0.927536231884058,
+        0.920863309352518, 0.9142857142857143, 0.9078014184397163,
+        0.9014084507042254, 0.8951048951048951, 0.8888888888888888,
+        0.8827586206896552, 0.8767123287671232, 0.8707482993197279,
+        0.8648648648648649, 0.8590604026845637, 0.8533333333333334,
+        0.847682119205298, 0.8421052631578947, 0.8366013071895425,
+        0.8311688311688312, 0.8258064516129032, 0.8205128205128205,
+        0.8152866242038217, 0.810126582278481, 0.8050314465408805,
+        0.8, 0.7950310559006211, 0.7901234567901234,
+        0.7852760736196319, 0.7804878048780488, 0.7757575757575758,
+        0.7710843373493976, 0.7664670658682635, 0.7619047619047619,
+        0.757396449704142, 0.7529411764705882, 0.7485380116959064,
+        0.7441860465116279, 0.7398843930635838, 0.735632183908046,
+        0.7314285714285714, 0.7272727272727273, 0.7231638418079096,
+        0.7191011235955056, 0.7150837988826816, 0.7111111111111111,
+        0.7071823204419889};
+    static const DDouble LOG_128TH[91] = {
+        {-0.3411707574027672, -3.1846151250956206e-18},
+        {-0.3302416868705768, -1.6927253978145054e-17},
+        {-0.3194307707663613, -2.5640385520940108e-17},
+        {-0.30873548164961323, -1.5025836482434425e-17},
+        {-0.2981533723190763, -1.575278736910067e-17},
+        {-0.28768207245178085, -2.6071606164425637e-17},
+        {-0.27731928541623435, 2.652724229158001e-17},
+        {-0.26706278524904514, -2.3896107240262357e-17},
+        {-0.2569104137850273, 9.92419178127068e-19},
+        {-0.2468600779315258, -6.678539813576451e-18},
+        {-0.23690974707835774, 1.3644270985951448e-17},
+        {-0.22705745063534608, 4.326372045075968e-18},
+        {-0.2173012756899813, 1.8526017065773163e-18},
+        {-0.20763936477824455, -1.2053243216686127e-17},
+        {-0.19806991376209387, -1.0681737386368664e-17},
+        {-0.18859116980754997, -9.915070540571144e-18},
+        {-0.17920142945771092, 2.111400074974391e-18},
+        {-0.16989903679539742, 4.868008764439086e-19},
+        {-0.16068238169047352, 3.650183553047839e-18},
+        {-0.15154989812720088, -1.2105853272368787e-17},
+        {-0.142500062607283, -9.155570001519129e-18},
+        {-0.13353139262452257, 3.664457663660086e-18},
+        {-0.12464244520727659, 5.8089126789409715e-18},
+        {-0.11583181552512165, -4.3384843698080944e-18},
+        {-0.10709813555636712, 3.4717745161358675e-18},
+        {-0.09844007281325251, 4.439009633675136e-18},
+        {-0.08985632912186114, -2.84207093558465e-18},
+        {-0.0813456394539524, -1.6076294039775555e-18},
+        {-0.07290677080808773, -5.836204074304871e-18},
+        {-0.06453852113757116, 6.470486661692933e-18},
+        {-0.05623971832287611, 3.2835149805605617e-18},
+        {-0.04800921918636066, 2.030356617224395e-18},
+        {-0.03984590854719978, 1.3948242043384064e-18},
+        {-0.03174869831458027, -3.0382263084680854e-18},
+        {-0.023716526617316065, 1.5774243488668216e-18},
+        {-0.015748356968139112, -1.0021578630528958e-18},
+        {-0.007843177461025879, -2.764708154124903e-19},
+        {0.0, 0.0},
+        {0.007782140442054963, -1.2819179123343749e-20},
+        {0.015504186535965199, -3.2783210228924137e-19},
+        {0.023167059281534418, -3.095927552179262e-19},
+        {0.03077165866675366, 1.0431732029005972e-18},
+        {0.03831886430213666, -2.3579961573512846e-18},
+        {0.04580953603129422, 1.6823639049745016e-19},
+        {0.05324451451881224, 1.803871134979952e-18},
+        {0.060624621816434854, 2.6424025938726934e-18},
+        {0.06795066190850778, 3.9239563038692484e-18},
+        {0.07522342123758752, -4.195880720316434e-18},
+        {0.08244366921107454, -4.707903082046854e-18},
+        {0.08961215868968717, -1.9573659817110993e-18},
+        {0.09672962645855114, -4.0291867005826106e-18},
+        {0.10379679368164355, -3.195893222617445e-18},
+        {0.11081436634029011, 2.0511100808140527e-18},
+        {0.11778303565638351, -1.1971685747593662e-18},
+        {0.12470347850095725, -4.6522609636496624e-18},
+        {0.13157635778871932, 1.112300087972959e-17},
+        {0.1384023228591192, -1.3766819196398948e-17},
+        {0.14518200984449783, 8.242418783022477e-18},
+        {0.151916042025842, 4.1233095848339465e-19},
+        {0.15860503017663852, 2.583386492298558e-18},
+        {0.16524957289530717, -9.227573884334224e-18},
+        {0.17185025692665928, -6.022453821011369e-18},
+        {0.17840765747281825, 1.2720936612962572e-17},
+        {0.18492233849401193, -7.384679440503435e-18},
+        {0.19139485299962947, -1.126213516780448e-17},
+        {0.19782574332991992, -7.995487338741543e-18},
+        {0.20421554142869083, 7.9379985298027e-18},
+        {0.21056476910734964, 1.136310596906137e-17},
+        {0.2168739383006143, 6.285749669211092e-18},
+        {0.2231435513142097, -9.091270597324798e-18},
+        {0.2293741010648459, -5.684839459813236e-18},
+        {0.23556607131276697, -2.394337149518734e-18},
+        {0.24171993688714513, 1.323779871210866e-17},
+        {0.2478361639045812, 8.384472133019162e-18},
+        {0.25391520998096345, -7.180735656435798e-18},
+        {0.259957524436926, 2.4167516341742964e-17},
+        {0.2659635484971379, 1.35209848201012e-19},
+        {0.2719337154836418, 7.833196376974436e-19},
+        {0.2778684510034563, 2.2502748630777633e-17},
+        {0.2837681731306446, -6.448868003452105e-18},
+        {0.2896332925830427, 2.0535953219858177e-17},
+        {0.2954642128938359, -7.768320796245443e-18},
+        {0.30126133057816185, -1.5120043309967385e-17},
+        {0.3070250352949119, 1.5578716077124932e-18},
+        {0.3127557100038969, -1.3650721793001109e-17},
+        {0.3184537311185346, -6.407962483026777e-19},
+        {0.324119468654212, -4.488767429940198e-18},
+        {0.32975328637246804, -2.5633554999431966e-17},
+        {0.3353555419211378, -1.3746739934976202e-17},
+        {0.3409265869705932, -2.069678002794501e-17},
+        {0.3464667673462086, -3.591951952851805e-18}};
+
+    static const double LOG_128TH_TAIL[91] = {
+        -1.5310027605611622e-34, -5.90581254077382e-34,
+        3.4335836190079215e-34, 8.225184367584692e-34,
+        -1.331684170036286e-33, -4.699413794904933e-34,
+        -8.732927663607953e-34, 1.2521867558882536e-33,
+        -1.1267352599497779e-35, 1.3427761332238647e-34,
+        -5.319950863383398e-34, -9.03248084774598e-35,
+        5.216073205396462e-35, -6.934295861642487e-34,
+        1.8066628338218584e-34, -1.88269992340476e-34,
+        -1.5796177269331044e-34, 2.761518034439742e-35,
+        -1.959251196939972e-34, 6.727529718955586e-34,
+        4.953098808326774e-34, -1.9543611395855355e-34,
+        -3.5076021423626465e-34, 1.966016315219788e-34,
+        -2.7266357918358635e-34, -1.0275939170581138e-34,
+        1.4718324501461808e-34, -7.169681969098387e-35,
+        2.579074627380538e-34, 2.5573177581653744e-34,
+        -1.6099675490717502e-34, 5.021471364917395e-35,
+        4.0182765106095705e-35, -5.938726465918062e-35,
+        -6.717706344838898e-36, 1.3230954218251744e-35,
+        -1.4373060040999001e-36, 0.0,
+        6.191991814581058e-37, -1.5904679466898835e-35,
+        -3.0465075204369026e-36, -7.246134058454665e-35,
+        8.592090817647135e-35, 6.196645617731986e-36,
+        1.3337963480178658e-34, -5.569417864413656e-36,
+        1.3724378866154364e-34, -3.0838795165233116e-35,
+        7.244509443495301e-35, 1.5106958354724012e-34,
+        1.529759233547028e-34, 1.9262304827007777e-35,
+        -1.0298039462731527e-34, 1.607407373808177e-35,
+        -2.4375471137303675e-34, -5.565016550131821e-34,
+        4.054737339285517e-34, -6.131085144129313e-34,
+        -1.880217963180494e-35, 1.523522753756252e-34,
+        6.366230455990136e-34, -1.0382896674242222e-34,
+        3.7500194417664297e-34, 6.413966935107311e-34,
+        -2.0000642613414285e-34, 9.252985807890424e-36,
+        -2.153273832060369e-34, -7.271860404173096e-34,
+        -1.4010267490618668e-34, 6.293766580876689e-34,
+        1.4736997314734489e-34, 3.214814747616349e-35,
+        -4.645857990053716e-34, 1.3547058510250993e-34,
+        -4.056734964982325e-34, 1.5246099306101538e-33,
+        -9.554134020816971e-36, 1.6898476119360942e-36,
+        -5.418690063270529e-34, 2.3862125134580813e-34,
+        -4.729408818817877e-34, -4.90899760752614e-34,
+        -1.1155850437478416e-33, -1.929927354683526e-36,
+        2.9332138265415314e-34, 1.2294050028499488e-35,
+        2.2172563909886757e-34, -1.5139135506350073e-33,
+        -6.20874970533104e-35, 9.885070031697271e-34,
+        2.3606455580743697e-34};
+
+    assert(k >= -37 && k <= 53);
+    r = RECIP_128TH[k + 37];
+    if (tail != nullptr)
+        *tail += LOG_128TH_TAIL[k + 37];
+    return LOG_128TH[k + 37];
+}
+
+static DDouble add_with_tail(DDouble x, DDouble y, double *tail)
 {
-    // Start with logarithm of hi part
-    DDouble log_x = std::log(x.hi());
-    if (!isfinite(log_x))
-        return log_x;
+    // As DDouble addition (Algorithm 6), but if tail is given, the rounding
+    // errors of the intermediate sums are added to it, such that the result
+    // plus tail is x + y up to terms of order u^3.
+    if (tail == nullptr)
+        return x + y;
+
+    DDouble s = ExDouble(x.hi()) + y.hi();
+    DDouble t = ExDouble(x.lo()) + y.lo();
+    DDouble c = ExDouble(s.lo()) + t.hi();
+    DDouble v = ExDouble(s.hi()).add_small(c.hi());
+    DDouble w = ExDouble(t.lo()) + v.lo();
+    *tail += c.lo() + w.lo();
+    return ExDouble(v.hi()).add_small(w.hi());
+}
 
-    // Abramowitz and Stegun give the following series expansion (4.1.30):
+static DDouble log1p_kernel(DDouble s, DDouble a, double *tail)
+{
+    // Computes a + log1p(s), where a is a value from the table.  If tail is
+    // given, the rounding errors of the final sums are added to it.
+    // Near zero, we use the series of the inverse hyperbolic tangent:
     //
-    //   log(x) = log(x0) + 2 (x - x0)/(x + x0) + O(x - x0)^3
+    //   log1p(s) = 2 atanh(u) = 2u + 2u^3/3 + 2u^5/5 + ...,   u = s/(2 + s)
     //
-    DDouble x0 = exp(log_x);
-    DDouble corr = PowerOfTwo(2.0) * x.add_small(-x0) / x.add_small(x0);
-    log_x += corr;
-    return log_x;
+    // Since 2u = s - s u, only s u depends on the division, which is small
+    // compared to s, so a quotient with a single correction step is enough.
+    assert(std::fabs(s.hi()) <= 0.0056);
+    const DDouble TWO_THIRDS(0.6666666666666666, 3.700743415417188e-17);
+    const DDouble TWO_FIFTHS(0.4, -2.2204460492503132e-17);
+
+    DDouble d = s + 2.0;
+    double inv = 1.0 / d.hi();
+    ExDouble u0 = s.hi() * inv;
+    DDouble rem = s - d * (double) u0;
+    DDouble u = u0.add_small(rem.hi() * inv);
+    DDouble u2 = u * u;
+    DDouble u3 = u * u2;
+    DDouble u5 = u3 * u2;
+
+    // The sum of the remaining terms is small compared to s, such that
+    // its rounding errors do not matter.
+    Accumulator c;
+    c.add_product(-s, u);
+    c.add_product(TWO_THIRDS, u3);
+    c.add_product(TWO_FIFTHS, u5);
+    DDouble u7 = u5 * u2;
+    c.add_product(0.2857142857142857, u7);
+
+    // From here on, the terms only affect the lo part.
+    double u2_d = u2.hi();
+    double c_d = 0.15384615384615385;
+    c_d = 0.18181818181818182 + c_d * u2_d;
+    c_d = 0.2222222222222222 + c_d * u2_d;
+    c += c_d * (u7.hi() * u2_d);
+
+    DDouble res = add_with_tail(s, c.value(), tail);
+    return add_with_tail(a, res, tail);
 }
 
-XPREC_API_EXPORT
-DDouble log1p(DDouble x)
+static DDouble log_impl(DDouble x, double dx, double *tail = nullptr)
 {
-    // Start with logarithm of hi part
-    DDouble log_x = std::log1p(x.hi());
-    if (!isfinite(log_x))
-        return log_x;
-
-    // Again, we can use the same correction, but log1p <-> expm1
+    // Computes log(x + dx) for positive, finite x, where dx is a correction
+    // below the lo part of x.  If tail is given, it is set such that the
+    // result plus tail is accurate to about u^3, which pow() needs for large
+    // exponents.  First, we split off the exponent:
     //
-    //   log(1 + x) = log(1 + x0) + 2 (x - x0)/(2 + x + x0) + O(x - x0)^3
+    //   log(x) = e log(2) + log(y),    y = x / 2^e in [sqrt(1/2), sqrt(2))
     //
-    // One need not worry about cancellation in the denominator for
-    // x close to -1, since that is where we have an intrinsic loss of
-    // precision anyway
-    DDouble x0 = expm1(log_x);
-    DDouble corr = PowerOfTwo(2.0) * x.add_small(-x0) / (2.0 + x).add_small(x0);
-    log_x += corr;
-    return log_x;
+    // Values close to the ends of the range are scaled first, such that
+    // 2^-e is a normal number.
+    const double TWO_POW_200 = 1.6069380442589903e+60;
+    int e = 0;
+    if (x.hi() < 1e-290) {
+        x *= PowerOfTwo(TWO_POW_200);
+        dx *= TWO_POW_200;
+        e = -200;
+    } else if (x.hi() > 1e290) {
+        x /= PowerOfTwo(TWO_POW_200);
+        dx /= TWO_POW_200;
+        e = 200;
+    }
+    int e_x = _internal::normal_exponent(x.hi());
+    if (x.hi() > 1.4142135623730951 * _internal::normal_power_of_two(e_x))
+        ++e_x;
+    PowerOfTwo scale = _internal::normal_power_of_two(-e_x);
+    DDouble y = x * scale;
+    dx = dx * scale;
+    e += e_x;
+
+    // Next, we reduce y against the nearest of the 1 + k/128:
+    //
+    //   log(y) = -log(r) + log1p(s),   s = y r - 1
+    //
+    // where r is 1/(1 + k/128) rounded to double.  The product y.hi * r is
+    // close enough to one for the subtraction to be exact, so s is as
+    // accurate as the remaining additions, and |s| <= 1/256 * sqrt(2).
+    // The offset makes the truncation round to nearest.
+    int k = (int) (128 * y.hi() - 63.5) - 64;
+    if (tail != nullptr)
+        *tail = 0.0;
+    double r;
+    DDouble log_y = log_128th(k, r, tail);
+    DDouble p = ExDouble(y.hi()) * r;
+    DDouble q = ExDouble(y.lo()) * r;
+    DDouble s = ExDouble(p.hi() - 1.0).add_small(p.lo());
+    s = add_with_tail(s, DDouble(q.hi(), q.lo() + dx * r), tail);
+    log_y = log1p_kernel(s, log_y, tail);
+    if (e == 0)
+        return log_y;
+
+    // Split log(2) such that multiplying the first two parts by e is exact.
+    const double LOG2_1 = 0.6931471805598903;
+    const double LOG2_2 = 5.4979230187085024e-14;
+    const double LOG2_3 = -1.3124698417785255e-27;
+    DDouble e_log2 = ExDouble(e * LOG2_1) + e * LOG2_2;
+    if (tail != nullptr)
+        *tail += e * LOG2_3;
+    else
+        log_y += e * LOG2_3;
+    return add_with_tail(e_log2, log_y, tail);
+}
+
+XPREC_API_EXPORT
+DDouble log(DDouble x)
+{
+    // Zero, negative and non-finite values
+    if (!(x.hi() > 0) || !_internal::is_finite(x.hi()))
+        return std::log(x.hi());
+
+    return log_impl(x, 0.0);
+}
+
+XPREC_API_EXPORT
+DDouble log1p(DDouble x)
+{
+    if (!_internal::is_finite(x.hi()))
+        return std::log1p(x.hi());
+
+    // For small values, we call the log1p kernel directly
+    if (std::fabs(x.hi()) <= 0.0055)
+        return log1p_kernel(x, 0.0, nullptr);
+
+    // Otherwise, we form y = 1 + x.  The rounding error l.lo of the lo part
+    // is passed on, since log1p is sensitive to it near zero.
+    DDouble t = ExDouble(x.hi()) + 1.0;
+    DDouble l = ExDouble(t.lo()) + x.lo();
+    DDouble y = ExDouble(t.hi()).add_small(l.hi());
+    if (!(y.hi() > 0))
+        return std::log(y.hi());
+
+    return log_impl(y, l.lo());
 }
 
 XPREC_API_EXPORT
@@ -358,6 +862,69 @@ DDouble pow(DDouble x, int n)
 }
 
 XPREC_API_EXPORT
-DDouble pow(DDouble x, DDouble y) { return exp(log(x) * y); }
+DDouble pow(DDouble x, DDouble y)
+{
+    // Integral and half-integral exponents are much faster by repeated
+    // multiplication.  Its error grows with the exponent, by roughly one ulp
+    // per unit of |y|, so larger exponents take the general path.  So do
+    // results (and intermediate powers) that are not well within the range
+    // of normal numbers, i.e., |y log2(x)| >= 960, where the multiplication
+    // would overflow to NaN or lose precision in subnormal numbers.
+    const double POW_INT_MAX = 8;
+    bool is_integral =
+        std::trunc(y.hi()) == y.hi() && std::trunc(y.lo()) == y.lo();
+    int e = _internal::normal_exponent(x.hi());
+    bool in_range = e > -1023 && e < 1024 &&
+                    std::fabs(y.hi()) * (std::fabs((double)e) + 1) < 960;
+    if (in_range && std::fabs(y.hi()) <= POW_INT_MAX) {
+        if (is_integral)
+            return pow(x, (int)y.hi());
+
+        double y2 = 2 * y.hi();
+        if (y.lo() == 0 && std::trunc(y2) == y2) {
+            if (y.hi() < 0)
+                return reciprocal(pow(x, -y));
+
+            DDouble res = sqrt(x);
+            if (y.hi() > 1)
+                res *= pow(x, (int)y.hi());
+            return res;
+        }
+    }
+
+    // Negative numbers have real powers only for integral exponents.
+    bool negate = false;
+    if (x.hi() < 0 && is_integral && _internal::is_finite(y.hi())) {
+        bool hi_odd = std::fmod(y.hi(), 2.0) != 0;
+        bool lo_odd = std::fmod(y.lo(), 2.0) != 0;
+        negate = hi_odd != lo_odd;
+        x = -x;
+    }
+    if (!(x.hi() > 0) || !_internal::is_finite(x.hi()) ||
+        !_internal::is_finite(y.hi()))
+        return std::pow(x.hi(), y.hi());
+
+    // Since exp(x) has an absolute condition number of one, the product
+    // y log(x) must be accurate to u^2 in absolute terms, more than double-
+    // double allows for large results.  We thus carry the tail of log(x)
+    // and form a triple-word product, where p.hi, p.lo, and p_tail add up
+    // to y log(x).  Only p_tail is subject to rounding errors.
+    double log_tail;
+    DDouble log_x = log_impl(x, 0.0, &log_tail);
+    DDouble a = ExDouble(y.hi()) * log_x.hi();
+    DDouble b = ExDouble(y.hi()) * log_x.lo();
+    DDouble c = ExDouble(y.lo()) * log_x.hi();
+    DDouble m = ExDouble(b.hi()) + c.hi();
+    DDouble n = ExDouble(a.lo()) + m.hi();
+    DDouble p = ExDouble(a.hi()).add_small(n.hi());
+    double p_tail = n.lo() + m.lo() + b.lo() + c.lo() +
+                    y.lo() * log_x.lo() + y.hi() * log_tail;
+
+    // exp(p + p_tail) = exp(p) (1 + p_tail), as p_tail is tiny.
+    DDouble res = exp(p);
+    if (_internal::is_finite(res.hi()))
+        res += res.hi() * p_tail;
+    return negate ? -res : res;
+}
 
 } // namespace xprec
@@ -36,7 +36,7 @@ DDouble nextafter(DDouble x, DDouble y)
     // fewer numbers).
     double lo;
     if (x.lo() == 0)
-        lo = std::copysign(std::numeric_limits<double>::min(), dir);
+        lo = std::copysign(DBL_MIN, dir);
     else
         lo = std::nextafter(x.lo(), dir);
 
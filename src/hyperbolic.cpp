@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: MIT
  */
 #include "taylor.hpp"
+#include "xprec/accumulator.hpp"
 #include "xprec/ddouble.hpp"
 #include "xprec/internal/utils.hpp"
 
@@ -13,87 +14,113 @@
 
 namespace xprec {
 
-XPREC_API_EXPORT
-DDouble cosh(DDouble x)
+static void sinhcosh_impl(DDouble x, DDouble *s, DDouble *c)
 {
-    // simply use the definition:
+    // Special values: infinities are preserved by sinh and made positive by
+    // cosh, NaN is preserved by both.
+    if (!isfinite(x)) {
+        if (s)
+            *s = x;
+        if (c)
+            *c = fabs(x);
+        return;
+    }
+
+    // For large |x|, 1/(e + 1) is below the lo part, so sinh(|x|) and
+    // cosh(x) both equal exp(|x|)/2.  Close to overflow, exp(|x|) itself is
+    // out of range before its half is, so we split off exp(1) instead, since
+    // subtracting one from |x| is exact.
+    DDouble ax = fabs(x);
+    if (ax.hi() >= 36.5) {
+        DDouble a;
+        if (ax.hi() < 709.0) {
+            a = PowerOfTwo(0.5) * exp(ax);
+        } else if (ax.hi() < 710.5) {
+            const DDouble E_HALF(1.3591409142295225, 7.228234458646251e-17);
+            a = exp(ax - 1.0) * E_HALF;
+            if (!isfinite(a))
+                a = DDouble(INFINITY, 0);
+        } else {
+            a = DDouble(INFINITY, 0);
+        }
+        if (s)
+            *s = x.hi() < 0 ? -a : a;
+        if (c)
+            *c = a;
+        return;
+    }
+
+    // With e = expm1(|x|), we have:
     //
-    //    2 cosh(x) = exp(x) + exp(-x) = exp(x) + 1/exp(x)
+    //   2 sinh(|x|) = e + e/(e + 1),    2 cosh(x) = (e + 1) + 1/(e + 1)
     //
-    x = abs(x);
-    DDouble res = exp(x);
-
-    // Only add something if indeed something can change.
-    if (x.hi() < 36.5)
-        res += reciprocal(res);
-    return PowerOfTwo(0.5) * res;
+    // The terms in the first sum have the same sign, so unlike the
+    // definition, it does not lose precision around zero.  Both share the
+    // reciprocal.
+    DDouble e = expm1(ax);
+    DDouble ep1 = e + 1.0;
+    DDouble r = reciprocal(ep1);
+    if (s) {
+        DDouble sa = fma(e, r, e);
+        *s = PowerOfTwo(0.5) * (x.hi() < 0 ? -sa : sa);
+    }
+    if (c)
+        *c = PowerOfTwo(0.5) * (ep1 + r);
 }
 
-static DDouble sinh_kernel(DDouble x)
+XPREC_API_EXPORT
+DDouble cosh(DDouble x)
 {
-    // We need to make sure that (exp(x) - exp(-x)) does not lose
-    // precision, which is why we need to have this work till abs(x) < 0.15.
-
-    // Convergence of the Taylor approx to 2e-32
-    assert(_internal::greater_in_magnitude(0.155, x.hi()));
-
-    // Taylor series of the sinh around 0
-    DDouble xsq = x * x;
-    DDouble r = x;
-    DDouble xpow = x;
-    for (int i = 3; i <= 17; i += 2) {
-        xpow *= xsq;
-        r = r.add_small(reciprocal_factorial(i) * xpow);
-    }
-    return r;
+    DDouble c;
+    sinhcosh_impl(x, nullptr, &c);
+    return c;
 }
 
 XPREC_API_EXPORT
 DDouble sinh(DDouble x)
 {
-    // Special values: +Inf, -Inf are all preserved
-    if (!isfinite(x))
-        return x;
-
-    // For small values, we use the Taylor series
-    if (std::fabs(x.hi()) < 0.15)
-        return sinh_kernel(x);
-
-    // Else we simply use the definition
-    if (x.hi() < 0)
-        return -sinh(-x);
-
-    DDouble res = exp(x);
+    DDouble s;
+    sinhcosh_impl(x, &s, nullptr);
+    return s;
+}
 
-    // Only add something if indeed something can change.
-    if (x.hi() < 36.5)
-        res -= reciprocal(res);
-    return PowerOfTwo(0.5) * res;
+XPREC_API_EXPORT
+void sinhcosh(DDouble x, DDouble &s, DDouble &c)
+{
+    // Evaluate the exponential only once for both
+    sinhcosh_impl(x, &s, &c);
 }
 
 static DDouble tanh_kernel(DDouble x)
 {
-    // Again we need to make sure that (exp(x) - exp(-x)) does not lose
-    // precision, which is why we need to have this work till abs(x) < 0.15.
-
-    // Convergence of the CF approx to 2e-32
+    // Continued fraction expansion of the tanh (Abramowitz and Stegun
+    // 4.5.70), truncated after the term x^2/19:
+    //
+    //   tanh(x) = x / (1 + x^2 / (3 + x^2 / (5 + ... + x^2 / 19)))
+    //
+    // Instead of evaluating it from the bottom up with one division per
+    // level, we write it out as x p(x^2) / q(x^2), where p and q have integer
+    // coefficients, which are exact in double.  All terms are positive, so
+    // Horner's scheme is stable.  We further write tanh(x) = x (1 + t),
+    // where t = -x^2 d(x^2) / q(x^2) with d = (q - p) / x^2.  Since |t| is
+    // below 0.014, its errors only weakly affect the result.
+
+    // Convergence of the truncated expansion to 2e-32
     assert(_internal::greater_in_magnitude(0.23, x));
 
-    // Continued fraction expansion of the tanh
-    // Abramowitz and Stegun 4.5.70
     DDouble xsq = x * x;
-    DDouble r;
-    r = xsq / 19.0;
-    r = xsq / (r + 17.0);
-    r = xsq / (r + 15.0);
-    r = xsq / (r + 13.0);
-    r = xsq / (r + 11.0);
-    r = xsq / (r + 9.0);
-    r = xsq / (r + 7.0);
-    r = xsq / (r + 5.0);
-    r = xsq / (r + 3.0);
-    r = x / (r + 1.0);
-    return r;
+    DDouble q = xsq + 1485.0;
+    q = fma(q, xsq, 315315.0);
+    q = fma(q, xsq, 18918900.0);
+    q = fma(q, xsq, 310134825.0);
+    q = fma(q, xsq, 654729075.0);
+
+    DDouble d = xsq + 1430.0;
+    d = fma(d, xsq, 289575.0);
+    d = fma(d, xsq, 16081065.0);
+    d = fma(d, xsq, 218243025.0);
+    DDouble t = -xsq * d / q;
+    return fma(x, t, x);
 }
 
 XPREC_API_EXPORT
@@ -107,14 +134,17 @@ DDouble tanh(DDouble x)
     if (std::fabs(x.hi()) < 0.2)
         return tanh_kernel(x);
 
-    // Asymptotically, we have +- 1
-    if (std::fabs(x.hi()) > 36.5)
+    // Asymptotically, we have +- 1, where 1 - tanh(x) ~ 2 exp(-2x) < u^2/8
+    if (std::fabs(x.hi()) > 38.0)
         return std::copysign(1.0, x.hi());
 
-    // Otherwise, simply use defitions
-    DDouble exp_x = exp(x);
-    DDouble exp_mx = reciprocal(exp_x);
-    return (exp_x - exp_mx) / (exp_x + exp_mx);
+    // Otherwise, use expm1 and a single division:
+    //
+    //   tanh(|x|) = e / (e + 2),    e = expm1(2 |x|)
+    //
+    DDouble e = expm1(PowerOfTwo(2.0) * fabs(x));
+    DDouble res = e / (e + 2.0);
+    return x.hi() < 0 ? -res : res;
 }
 
 XPREC_API_EXPORT
@@ -160,7 +190,7 @@ DDouble asinh(DDouble x)
     // cannot overflow.
     DDouble arg = fabs(x);
     if (arg.hi() <= 1e16)
-        arg = sqrt(arg * arg + 1.0).add_small(arg);
+        arg = sqrt(fma(arg, arg, 1.0)).add_small(arg);
     else
         // XXX for very large values this may still overflow.
         arg = PowerOfTwo(2.0) * arg;
@@ -0,0 +1,19 @@
+/* Mathematical functions compiled for CPUs with FMA.
+ *
+ * This file is compiled with -mfma and only called through the runtime
+ * dispatch in mathfn.cpp.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#if !defined(__FMA__)
+#error "This file must be compiled with FMA enabled"
+#endif
+
+// Always use FMA here, even if the baseline is built without it
+#undef XPREC_USE_FMA
+#define XPREC_USE_FMA 1
+
+#define XPREC_MATHFN_NAMESPACE xprec_fma
+#define XPREC_MATHFN_TABLE FMA_FUNCTIONS
+#include "mathfn-variant.hpp"
@@ -0,0 +1,8 @@
+/* Mathematical functions compiled for the baseline instruction set.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#define XPREC_MATHFN_NAMESPACE xprec_generic
+#define XPREC_MATHFN_TABLE GENERIC_FUNCTIONS
+#include "mathfn-variant.hpp"
@@ -0,0 +1,182 @@
+/* One variant of the mathematical functions (see mathfn.hpp).
+ *
+ * Before including this file, define XPREC_MATHFN_NAMESPACE to the namespace
+ * that the variant is compiled into and XPREC_MATHFN_TABLE to the name of
+ * the table to define.  Include this file exactly once per translation unit,
+ * and make sure that it is the first xprec header included.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "mathfn.hpp"
+
+#if !defined(XPREC_MATHFN_NAMESPACE) || !defined(XPREC_MATHFN_TABLE)
+#error "Must define XPREC_MATHFN_NAMESPACE and XPREC_MATHFN_TABLE"
+#endif
+
+// Pull in the standard headers before changing visibility
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+// Compile everything, including the inline functions in the headers, into
+// a namespace of our own.  Keep these symbols out of the dynamic symbol table.
+#define xprec XPREC_MATHFN_NAMESPACE
+#pragma GCC visibility push(hidden)
+
+#include "circular.cpp"
+#include "exp.cpp"
+#include "floats.cpp"
+#include "gauss.cpp"
+#include "hyperbolic.cpp"
+#include "sqrt.cpp"
+
+namespace xprec {
+namespace _cfunctions {
+
+static DDouble from_c(xprec_ddouble x) { return DDouble(x.hi, x.lo); }
+
+static xprec_ddouble to_c(DDouble x) { return {x.hi(), x.lo()}; }
+
+#define UNARY_FN(fn)                                                           \
+    static xprec_ddouble fn(xprec_ddouble x)                                   \
+    {                                                                          \
+        return to_c(xprec::fn(from_c(x)));                                     \
+    }
+
+#define BINARY_FN(fn)                                                          \
+    static xprec_ddouble fn(xprec_ddouble x, xprec_ddouble y)                  \
+    {                                                                          \
+        return to_c(xprec::fn(from_c(x), from_c(y)));                          \
+    }
+
+// Avoid std::vector and std::unique_ptr here, which instantiate helpers that
+// do not depend on DDouble, such as std::min<size_t>, and are thus shared
+// with the baseline.
+#define QUADRATURE_FN(fn)                                                      \
+    static void fn(int n, xprec_ddouble *x, xprec_ddouble *w)                  \
+    {                                                                          \
+        size_t size = n > 0 ? n : 0;                                           \
+        DDouble *xd = new DDouble[size];                                       \
+        DDouble *wd = new DDouble[size];                                       \
+        xprec::fn(n, xd, w != nullptr ? wd : nullptr);                         \
+        for (size_t i = 0; i != size; ++i) {                                   \
+            x[i] = to_c(xd[i]);                                                \
+            if (w != nullptr)                                                  \
+                w[i] = to_c(wd[i]);                                            \
+        }                                                                      \
+        delete[] xd;                                                           \
+        delete[] wd;                                                           \
+    }
+
+UNARY_FN(exp)
+UNARY_FN(expm1)
+UNARY_FN(log)
+UNARY_FN(log1p)
+BINARY_FN(pow)
+
+static xprec_ddouble powi(xprec_ddouble x, int n)
+{
+    return to_c(xprec::pow(from_c(x), n));
+}
+
+UNARY_FN(trig_complement)
+UNARY_FN(sin)
+UNARY_FN(cos)
+UNARY_FN(tan)
+UNARY_FN(asin)
+UNARY_FN(acos)
+UNARY_FN(atan)
+BINARY_FN(atan2)
+
+static void sincos(xprec_ddouble x, xprec_ddouble *s, xprec_ddouble *c)
+{
+    DDouble sd, cd;
+    xprec::sincos(from_c(x), sd, cd);
+    *s = to_c(sd);
+    *c = to_c(cd);
+}
+
+UNARY_FN(cosh)
+UNARY_FN(sinh)
+
+static void sinhcosh(xprec_ddouble x, xprec_ddouble *s, xprec_ddouble *c)
+{
+    DDouble sd, cd;
+    xprec::sinhcosh(from_c(x), sd, cd);
+    *s = to_c(sd);
+    *c = to_c(cd);
+}
+
+UNARY_FN(tanh)
+UNARY_FN(acosh)
+UNARY_FN(asinh)
+UNARY_FN(atanh)
+
+UNARY_FN(sqrt)
+BINARY_FN(hypot)
+
+static xprec_ddouble modf(xprec_ddouble x, xprec_ddouble *i)
+{
+    DDouble id;
+    DDouble r = xprec::modf(from_c(x), id);
+    *i = to_c(id);
+    return to_c(r);
+}
+
+QUADRATURE_FN(gauss_chebyshev)
+QUADRATURE_FN(gauss_legendre)
+
+#undef UNARY_FN
+#undef BINARY_FN
+#undef QUADRATURE_FN
+
+} // namespace _cfunctions
+} // namespace xprec
+
+#pragma GCC visibility pop
+#undef xprec
+
+namespace xprec {
+namespace _mathfn {
+
+extern const Functions XPREC_MATHFN_TABLE;
+
+const Functions XPREC_MATHFN_TABLE = {
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::exp,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::expm1,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::log,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::log1p,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::powi,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::pow,
+
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::trig_complement,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::sin,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::cos,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::sincos,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::tan,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::asin,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::acos,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::atan,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::atan2,
+
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::cosh,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::sinh,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::sinhcosh,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::tanh,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::acosh,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::asinh,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::atanh,
+
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::sqrt,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::hypot,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::modf,
+
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::gauss_chebyshev,
+    &XPREC_MATHFN_NAMESPACE::_cfunctions::gauss_legendre,
+};
+
+} // namespace _mathfn
+} // namespace xprec
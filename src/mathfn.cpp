@@ -0,0 +1,105 @@
+/* Public mathematical functions, dispatched at runtime (see mathfn.hpp).
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "mathfn.hpp"
+#include "xprec/array.hpp"
+#include "xprec/ddouble.hpp"
+#include <vector>
+
+namespace xprec {
+
+static const _mathfn::Functions &functions()
+{
+    // All CPUs that support AVX2 also support FMA (see array.cpp), and
+    // following simd_level() allows set_simd_level() to select the variant.
+    if (simd_level() >= SimdLevel::AVX2)
+        return _mathfn::FMA_FUNCTIONS;
+    return _mathfn::GENERIC_FUNCTIONS;
+}
+
+static DDouble from_c(xprec_ddouble x) { return DDouble(x.hi, x.lo); }
+
+static xprec_ddouble to_c(DDouble x) { return {x.hi(), x.lo()}; }
+
+#define UNARY_FN(fn)                                                           \
+    DDouble fn(DDouble x) { return from_c(functions().fn(to_c(x))); }
+
+#define BINARY_FN(fn)                                                          \
+    DDouble fn(DDouble x, DDouble y)                                           \
+    {                                                                          \
+        return from_c(functions().fn(to_c(x), to_c(y)));                       \
+    }
+
+// The types are layout-compatible, but we copy rather than pun them
+#define QUADRATURE_FN(fn)                                                      \
+    void fn(int n, DDouble x[], DDouble w[])                                   \
+    {                                                                          \
+        std::vector<xprec_ddouble> xc(n > 0 ? n : 0), wc(n > 0 ? n : 0);       \
+        functions().fn(n, xc.data(), w != nullptr ? wc.data() : nullptr);      \
+        for (size_t i = 0; i != xc.size(); ++i) {                              \
+            x[i] = from_c(xc[i]);                                              \
+            if (w != nullptr)                                                  \
+                w[i] = from_c(wc[i]);                                          \
+        }                                                                      \
+    }
+
+UNARY_FN(exp)
+UNARY_FN(expm1)
+UNARY_FN(log)
+UNARY_FN(log1p)
+BINARY_FN(pow)
+
+DDouble pow(DDouble x, int n) { return from_c(functions().powi(to_c(x), n)); }
+
+UNARY_FN(trig_complement)
+UNARY_FN(sin)
+UNARY_FN(cos)
+UNARY_FN(tan)
+UNARY_FN(asin)
+UNARY_FN(acos)
+UNARY_FN(atan)
+BINARY_FN(atan2)
+
+void sincos(DDouble x, DDouble &s, DDouble &c)
+{
+    xprec_ddouble sc, cc;
+    functions().sincos(to_c(x), &sc, &cc);
+    s = from_c(sc);
+    c = from_c(cc);
+}
+
+UNARY_FN(cosh)
+UNARY_FN(sinh)
+
+void sinhcosh(DDouble x, DDouble &s, DDouble &c)
+{
+    xprec_ddouble sc, cc;
+    functions().sinhcosh(to_c(x), &sc, &cc);
+    s = from_c(sc);
+    c = from_c(cc);
+}
+
+UNARY_FN(tanh)
+UNARY_FN(acosh)
+UNARY_FN(asinh)
+UNARY_FN(atanh)
+
+UNARY_FN(sqrt)
+BINARY_FN(hypot)
+
+DDouble modf(DDouble x, DDouble &i)
+{
+    xprec_ddouble ic;
+    DDouble r = from_c(functions().modf(to_c(x), &ic));
+    i = from_c(ic);
+    return r;
+}
+
+DDouble modf(DDouble x, DDouble *iptr) { return modf(x, *iptr); }
+
+QUADRATURE_FN(gauss_chebyshev)
+QUADRATURE_FN(gauss_legendre)
+
+} // namespace xprec
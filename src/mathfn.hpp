@@ -0,0 +1,90 @@
+/* Runtime dispatch of the mathematical functions.
+ *
+ * The functions in exp.cpp, circular.cpp, hyperbolic.cpp, sqrt.cpp and
+ * gauss.cpp are built from many double-double multiplications, which are
+ * much faster with FMA (see XPREC_USE_FMA).  To get this speed-up without
+ * giving up portable binaries, these files are compiled twice: once for the
+ * baseline (mathfn-generic.cpp) and once with FMA (mathfn-fma.cpp).
+ *
+ * Since the inline functions from the headers differ between the two, each
+ * variant is compiled into a namespace of its own: otherwise, the linker may
+ * pick the FMA copy of, say, operator* for use in the baseline code, which
+ * would crash on CPUs without FMA.  The namespace does not cover inline
+ * functions of the standard library that do not depend on our types, such
+ * as std::isfinite or std::min<size_t>, which the variants thus must not use
+ * (see internal/arith.hpp).  For the same reason, the variants expose
+ * their functions through a table using only the C types from ddouble.h.
+ * mathfn.cpp then defines the public functions, which forward to the
+ * variant selected at runtime.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include "xprec/ddouble.h"
+
+namespace xprec {
+namespace _mathfn {
+
+using UnaryFunction = xprec_ddouble (*)(xprec_ddouble x);
+
+using BinaryFunction = xprec_ddouble (*)(xprec_ddouble x, xprec_ddouble y);
+
+using PowiFunction = xprec_ddouble (*)(xprec_ddouble x, int n);
+
+using SplitFunction = xprec_ddouble (*)(xprec_ddouble x, xprec_ddouble *i);
+
+using PairFunction = void (*)(xprec_ddouble x, xprec_ddouble *s,
+                              xprec_ddouble *c);
+
+using QuadratureFunction = void (*)(int n, xprec_ddouble *x,
+                                    xprec_ddouble *w);
+
+/** Table of mathematical functions for one instruction set */
+struct Functions {
+    // exp.cpp
+    UnaryFunction exp;
+    UnaryFunction expm1;
+    UnaryFunction log;
+    UnaryFunction log1p;
+    PowiFunction powi;
+    BinaryFunction pow;
+
+    // circular.cpp
+    UnaryFunction trig_complement;
+    UnaryFunction sin;
+    UnaryFunction cos;
+    PairFunction sincos;
+    UnaryFunction tan;
+    UnaryFunction asin;
+    UnaryFunction acos;
+    UnaryFunction atan;
+    BinaryFunction atan2;
+
+    // hyperbolic.cpp
+    UnaryFunction cosh;
+    UnaryFunction sinh;
+    PairFunction sinhcosh;
+    UnaryFunction tanh;
+    UnaryFunction acosh;
+    UnaryFunction asinh;
+    UnaryFunction atanh;
+
+    // sqrt.cpp
+    UnaryFunction sqrt;
+    BinaryFunction hypot;
+    SplitFunction modf;
+
+    // gauss.cpp
+    QuadratureFunction gauss_chebyshev;
+    QuadratureFunction gauss_legendre;
+};
+
+/** Functions compiled for the baseline (defined in mathfn-generic.cpp) */
+extern const Functions GENERIC_FUNCTIONS;
+
+/** Functions compiled with FMA (defined in mathfn-fma.cpp) */
+extern const Functions FMA_FUNCTIONS;
+
+} // namespace _mathfn
+} // namespace xprec
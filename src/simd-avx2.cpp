@@ -0,0 +1,21 @@
+/* Vectorized kernels for CPUs with AVX2 and FMA.
+ *
+ * This file is compiled with -mavx2 -mfma and only called through the
+ * runtime dispatch in array.cpp.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "simd.hpp"
+
+#if !defined(__AVX2__) || !defined(__FMA__)
+#error "This file must be compiled with AVX2 and FMA enabled"
+#endif
+
+namespace xprec {
+namespace _simd {
+
+const Kernels AVX2_KERNELS = KernelsFor<Avx2>::table();
+
+} // namespace _simd
+} // namespace xprec
@@ -0,0 +1,21 @@
+/* Vectorized kernels for CPUs with AVX-512F.
+ *
+ * This file is compiled with -mavx512f -mfma and only called through the
+ * runtime dispatch in array.cpp.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "simd.hpp"
+
+#if !defined(__AVX512F__)
+#error "This file must be compiled with AVX-512F enabled"
+#endif
+
+namespace xprec {
+namespace _simd {
+
+const Kernels AVX512_KERNELS = KernelsFor<Avx512>::table();
+
+} // namespace _simd
+} // namespace xprec
@@ -0,0 +1,1282 @@
+/* Vectorized double-double kernels.
+ *
+ * The error-free transformations and double-double algorithms are written
+ * once as templates over a "vector of doubles" type V.  Each V must provide
+ * the operators +, -, *, /, the free functions fmadd(), neg(), flipsign(),
+ * max() and all_finite(), as well as static load(), store(), gather(),
+ * scatter() and broadcast() functions and a `width` constant.
+ *
+ * The kernels perform bit-for-bit the same operations as the scalar DDouble
+ * operators in arith.hpp, which is why SIMD loops can use the one-lane Scalar
+ * type for their remainder and still give results that are bit-identical to
+ * the scalar code.  This includes builds without FMA (XPREC_USE_FMA=0): there,
+ * the kernels use Dekker's product and unfused operations for all types, even
+ * though the vector types have FMA, since the scalar operators cannot use it.
+ * The build must thus pass the baseline's XPREC_USE_FMA to the translation
+ * units compiled with -mfma (see CMakeLists.txt).
+ *
+ * This header is included by translation units compiled for different
+ * instruction sets (simd-avx2.cpp, simd-avx512.cpp).  For this reason,
+ * everything except the kernel table is in an unnamed namespace: otherwise,
+ * the linker may pick, say, the AVX2 copy of an inline function for use in
+ * the baseline code, which would crash on CPUs without AVX2.  For the same
+ * reason, the kernels operate on raw pointers rather than spans.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include "xprec/ddouble-fwd.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace xprec {
+namespace _simd {
+
+using BinaryKernel = void (*)(size_t n, const double *xhi, const double *xlo,
+                              const double *yhi, const double *ylo,
+                              double *outhi, double *outlo);
+
+using UnaryKernel = void (*)(size_t n, const double *xhi, const double *xlo,
+                             double *outhi, double *outlo);
+
+using ScaledKernel = void (*)(double ahi, double alo, size_t n,
+                              const double *xhi, const double *xlo,
+                              double *outhi, double *outlo);
+
+using AxpyKernel = void (*)(double ahi, double alo, size_t n,
+                            const double *xhi, const double *xlo,
+                            double *yhi, double *ylo);
+
+using DotKernel = void (*)(size_t n, const double *xhi, const double *xlo,
+                          size_t incx, const double *yhi, const double *ylo,
+                          size_t incy, double *out);
+
+using DoubleDotKernel = void (*)(size_t n, const double *x, const double *y,
+                                double *out);
+
+using SumKernel = void (*)(size_t n, const double *xhi, const double *xlo,
+                           size_t incx, double *out);
+
+using DoubleSumKernel = void (*)(size_t n, const double *x, double *out);
+
+using SumSquaresKernel = void (*)(double scale, size_t n, const double *xhi,
+                                  const double *xlo, size_t incx, double *out);
+
+using AbsMaxKernel = double (*)(size_t n, const double *xhi, size_t incx);
+
+/** Largest number of levels of a binned sum */
+constexpr size_t BINNED_MAX_LEVELS = 8;
+
+/** Terms of a reduction, selected at runtime (see blas.cpp) */
+struct TermArgs {
+    enum Kind { SUM, SUM_DOUBLE, DOT, DOT_DOUBLE };
+
+    Kind kind;
+    const double *xhi, *xlo;
+    size_t incx;
+    const double *yhi, *ylo;
+    size_t incy;
+};
+
+using TermStatsKernel = void (*)(const TermArgs &terms, size_t begin,
+                                 size_t end, double *out);
+
+using BinnedSumKernel = void (*)(const TermArgs &terms, size_t begin,
+                                 size_t end, double scale, const double *m,
+                                 size_t levels, double *sums);
+
+using StridedAxpyKernel = void (*)(double ahi, double alo, size_t n,
+                                   const double *xhi, const double *xlo,
+                                   size_t incx, double *yhi, double *ylo,
+                                   size_t incy);
+
+using StridedScaleKernel = void (*)(double ahi, double alo, size_t n,
+                                    double *xhi, double *xlo, size_t incx);
+
+using GemmKernel = void (*)(size_t mc, size_t nc, size_t kc,
+                           const double *apack, const double *bpack,
+                           double *c, size_t ldc);
+
+/** Number of columns of C computed at once by the gemm micro-kernel */
+constexpr size_t GEMM_NR = 4;
+
+/** Largest number of rows of C computed at once by any gemm micro-kernel */
+constexpr size_t GEMM_MAX_MR = 8;
+
+/** Table of kernels for one instruction set */
+struct Kernels {
+    BinaryKernel add;
+    BinaryKernel sub;
+    BinaryKernel mul;
+    BinaryKernel div;
+    ScaledKernel scale;
+    ScaledKernel scale_right;
+    AxpyKernel axpy;
+    UnaryKernel reciprocal;
+
+    // Strided kernels for blas.cpp: reductions write hi and lo to out[0:2]
+    DotKernel dot;
+    DoubleDotKernel dot2;
+    SumKernel sum;
+    DoubleSumKernel sum_double;
+    SumKernel asum;
+    SumSquaresKernel sum_squares;
+    AbsMaxKernel abs_max;
+    TermStatsKernel term_stats;
+    BinnedSumKernel binned_sum;
+    StridedAxpyKernel axpy_strided;
+    StridedScaleKernel scale_strided;
+
+    // Matrix-matrix product of packed blocks (see blas.cpp for the layout)
+    size_t gemm_mr;
+    GemmKernel gemm;
+};
+
+/** Kernels for the current SIMD level (defined in array.cpp) */
+const Kernels &current_kernels();
+
+#ifdef XPREC_SIMD_DISPATCH
+/** Kernels compiled for AVX2 and FMA (defined in simd-avx2.cpp) */
+extern const Kernels AVX2_KERNELS;
+
+/** Kernels compiled for AVX-512F (defined in simd-avx512.cpp) */
+extern const Kernels AVX512_KERNELS;
+#endif
+
+namespace {
+
+// The classification functions from <cmath> are inline functions with
+// external linkage, which unoptimized builds emit out of line, so we need
+// copies of our own for the same reason as above.
+#if defined(__GNUC__)
+inline bool is_finite(double x) { return __builtin_isfinite(x); }
+inline bool sign_bit(double x) { return __builtin_signbit(x); }
+#else
+inline bool is_finite(double x) { return std::isfinite(x); }
+inline bool sign_bit(double x) { return std::signbit(x); }
+#endif
+
+/** One lane: plain double arithmetic */
+struct Scalar {
+    static constexpr size_t width = 1;
+
+    double v;
+
+    static Scalar load(const double *p) { return {*p}; }
+    static Scalar gather(const double *p, size_t) { return {*p}; }
+    static Scalar broadcast(double x) { return {x}; }
+    static void store(double *p, Scalar x) { *p = x.v; }
+    static void scatter(double *p, size_t, Scalar x) { *p = x.v; }
+
+    friend Scalar operator+(Scalar a, Scalar b) { return {a.v + b.v}; }
+    friend Scalar operator-(Scalar a, Scalar b) { return {a.v - b.v}; }
+    friend Scalar operator*(Scalar a, Scalar b) { return {a.v * b.v}; }
+    friend Scalar operator/(Scalar a, Scalar b) { return {a.v / b.v}; }
+    friend Scalar neg(Scalar a) { return {-a.v}; }
+
+    friend Scalar flipsign(Scalar a, Scalar s)
+    {
+        return {sign_bit(s.v) ? -a.v : a.v};
+    }
+
+    friend Scalar max(Scalar a, Scalar b) { return {a.v > b.v ? a.v : b.v}; }
+
+    friend Scalar fmadd(Scalar a, Scalar b, Scalar c)
+    {
+        return {std::fma(a.v, b.v, c.v)};
+    }
+
+    friend bool all_finite(Scalar a) { return is_finite(a.v); }
+};
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+/** Four lanes: AVX2 with fused multiply-add */
+struct Avx2 {
+    static constexpr size_t width = 4;
+
+    __m256d v;
+
+    static Avx2 load(const double *p) { return {_mm256_loadu_pd(p)}; }
+    static Avx2 broadcast(double x) { return {_mm256_set1_pd(x)}; }
+    static void store(double *p, Avx2 x) { _mm256_storeu_pd(p, x.v); }
+
+    static Avx2 gather(const double *p, size_t inc)
+    {
+        __m256i idx = _mm256_set_epi64x(3 * inc, 2 * inc, inc, 0);
+        return {_mm256_i64gather_pd(p, idx, sizeof(double))};
+    }
+
+    static void scatter(double *p, size_t inc, Avx2 x)
+    {
+        // AVX2 has no scatter instruction
+        alignas(32) double tmp[width];
+        _mm256_store_pd(tmp, x.v);
+        for (size_t i = 0; i != width; ++i)
+            p[i * inc] = tmp[i];
+    }
+
+    friend Avx2 operator+(Avx2 a, Avx2 b) { return {_mm256_add_pd(a.v, b.v)}; }
+    friend Avx2 operator-(Avx2 a, Avx2 b) { return {_mm256_sub_pd(a.v, b.v)}; }
+    friend Avx2 operator*(Avx2 a, Avx2 b) { return {_mm256_mul_pd(a.v, b.v)}; }
+    friend Avx2 operator/(Avx2 a, Avx2 b) { return {_mm256_div_pd(a.v, b.v)}; }
+
+    friend Avx2 neg(Avx2 a)
+    {
+        // Flip the sign bit, which unlike 0 - a also works for signed zeros
+        return {_mm256_xor_pd(a.v, _mm256_set1_pd(-0.0))};
+    }
+
+    friend Avx2 fmadd(Avx2 a, Avx2 b, Avx2 c)
+    {
+        return {_mm256_fmadd_pd(a.v, b.v, c.v)};
+    }
+
+    friend Avx2 flipsign(Avx2 a, Avx2 s)
+    {
+        __m256d sign = _mm256_and_pd(s.v, _mm256_set1_pd(-0.0));
+        return {_mm256_xor_pd(a.v, sign)};
+    }
+
+    friend Avx2 max(Avx2 a, Avx2 b) { return {_mm256_max_pd(a.v, b.v)}; }
+
+    friend bool all_finite(Avx2 a)
+    {
+        // a - a is zero for finite lanes and NaN otherwise
+        __m256d z = _mm256_sub_pd(a.v, a.v);
+        return _mm256_movemask_pd(_mm256_cmp_pd(z, z, _CMP_ORD_Q)) == 0xF;
+    }
+};
+
+#endif
+
+#if defined(__AVX512F__)
+
+/** Eight lanes: AVX-512F, which includes fused multiply-add */
+struct Avx512 {
+    static constexpr size_t width = 8;
+
+    __m512d v;
+
+    static Avx512 load(const double *p) { return {_mm512_loadu_pd(p)}; }
+    static Avx512 broadcast(double x) { return {_mm512_set1_pd(x)}; }
+    static void store(double *p, Avx512 x) { _mm512_storeu_pd(p, x.v); }
+
+    static __m512i stride_index(size_t inc)
+    {
+        return _mm512_set_epi64(7 * inc, 6 * inc, 5 * inc, 4 * inc, 3 * inc,
+                                2 * inc, inc, 0);
+    }
+
+    static Avx512 gather(const double *p, size_t inc)
+    {
+        // The masked variant avoids a spurious warning in GCC's intrinsics
+        return {_mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF,
+                                         stride_index(inc), p, sizeof(double))};
+    }
+
+    static void scatter(double *p, size_t inc, Avx512 x)
+    {
+        _mm512_i64scatter_pd(p, stride_index(inc), x.v, sizeof(double));
+    }
+
+    friend Avx512 operator+(Avx512 a, Avx512 b)
+    {
+        return {_mm512_add_pd(a.v, b.v)};
+    }
+
+    friend Avx512 operator-(Avx512 a, Avx512 b)
+    {
+        return {_mm512_sub_pd(a.v, b.v)};
+    }
+
+    friend Avx512 operator*(Avx512 a, Avx512 b)
+    {
+        return {_mm512_mul_pd(a.v, b.v)};
+    }
+
+    friend Avx512 operator/(Avx512 a, Avx512 b)
+    {
+        return {_mm512_div_pd(a.v, b.v)};
+    }
+
+    friend Avx512 neg(Avx512 a)
+    {
+        // AVX-512F lacks floating-point xor, so flip the sign bit as integer
+        __m512i sign = _mm512_set1_epi64(INT64_MIN);
+        return {_mm512_castsi512_pd(
+                _mm512_xor_si512(_mm512_castpd_si512(a.v), sign))};
+    }
+
+    friend Avx512 fmadd(Avx512 a, Avx512 b, Avx512 c)
+    {
+        return {_mm512_fmadd_pd(a.v, b.v, c.v)};
+    }
+
+    friend Avx512 flipsign(Avx512 a, Avx512 s)
+    {
+        __m512i sign = _mm512_and_si512(_mm512_castpd_si512(s.v),
+                                        _mm512_set1_epi64(INT64_MIN));
+        return {_mm512_castsi512_pd(
+                _mm512_xor_si512(_mm512_castpd_si512(a.v), sign))};
+    }
+
+    friend Avx512 max(Avx512 a, Avx512 b)
+    {
+        // Same as _mm512_max_pd, which triggers a spurious warning in GCC
+        __mmask8 a_greater = _mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ);
+        return {_mm512_mask_blend_pd(a_greater, b.v, a.v)};
+    }
+
+    friend bool all_finite(Avx512 a)
+    {
+        // a - a is zero for finite lanes and NaN otherwise
+        __m512d z = _mm512_sub_pd(a.v, a.v);
+        return _mm512_cmp_pd_mask(z, z, _CMP_ORD_Q) == 0xFF;
+    }
+};
+
+#endif
+
+#if defined(__AVX512F__)
+#define XPREC_SIMD_NATIVE Avx512
+#elif defined(__AVX2__) && defined(__FMA__)
+#define XPREC_SIMD_NATIVE Avx2
+#else
+#define XPREC_SIMD_NATIVE Scalar
+#endif
+
+/** Widest vector type available at compile time */
+using Native = XPREC_SIMD_NATIVE;
+
+#undef XPREC_SIMD_NATIVE
+
+/** A vector of double-doubles in structure-of-arrays form */
+template <typename V>
+struct DD {
+    V hi, lo;
+
+    static DD load(const double *hi, const double *lo)
+    {
+        return {V::load(hi), V::load(lo)};
+    }
+
+    static DD broadcast(double hi, double lo)
+    {
+        return {V::broadcast(hi), V::broadcast(lo)};
+    }
+
+    static void store(double *hi, double *lo, DD x)
+    {
+        V::store(hi, x.hi);
+        V::store(lo, x.lo);
+    }
+
+    /** Load elements which are inc doubles apart */
+    static DD load(const double *hi, const double *lo, size_t inc)
+    {
+        if (inc == 1)
+            return load(hi, lo);
+        return {V::gather(hi, inc), V::gather(lo, inc)};
+    }
+
+    /** Store elements which are inc doubles apart */
+    static void store(double *hi, double *lo, size_t inc, DD x)
+    {
+        if (inc == 1) {
+            store(hi, lo, x);
+        } else {
+            V::scatter(hi, inc, x.hi);
+            V::scatter(lo, inc, x.lo);
+        }
+    }
+};
+
+// -------------------------------------------------------------------------
+// Kernels (see arith.hpp for the scalar versions and error bounds)
+
+template <typename V>
+inline DD<V> fast_two_sum(V a, V b)
+{
+    // Algorithm 1: cost 3 flops
+    V s = a + b;
+    V z = s - a;
+    V t = b - z;
+    return {s, t};
+}
+
+template <typename V>
+inline DD<V> two_sum(V a, V b)
+{
+    // Algorithm 2: cost 6 flops
+    V s = a + b;
+    V aprime = s - b;
+    V bprime = s - aprime;
+    V delta_a = a - aprime;
+    V delta_b = b - bprime;
+    V t = delta_a + delta_b;
+    return {s, t};
+}
+
+#if XPREC_USE_FMA
+
+template <typename V>
+inline DD<V> two_prod(V a, V b)
+{
+    // Algorithm 3: cost 2 flops
+    V pi = a * b;
+    V rho = fmadd(a, b, neg(pi));
+    return {pi, rho};
+}
+
+#else
+
+template <typename V>
+inline void veltkamp_split(V a, V &hi, V &lo)
+{
+    // See arith.hpp
+    const V splitter = V::broadcast(134217729.0); // 2^27 + 1
+    V gamma = splitter * a;
+    hi = gamma - (gamma - a);
+    lo = a - hi;
+}
+
+template <typename V>
+inline V dekker_error(V a, V b, V pi)
+{
+    V ah, al, bh, bl;
+    veltkamp_split(a, ah, al);
+    veltkamp_split(b, bh, bl);
+    return ((ah * bh - pi) + ah * bl + al * bh) + al * bl;
+}
+
+inline double scaled_dekker_error(double a, double b, double pi, double rho)
+{
+    // The splitting or one of the partial products overflowed, so we scale
+    // down the larger factor, as in arith.hpp
+    if (is_finite(rho) || !is_finite(pi))
+        return rho;
+
+    const double down = 1.1102230246251565e-16; // 2^-53
+    Scalar big = {a}, small = {b};
+    if (std::fabs(a) < std::fabs(b))
+        big = {b}, small = {a};
+    Scalar scaled = dekker_error(Scalar{big.v * down}, small, Scalar{pi * down});
+    return scaled.v / down;
+}
+
+template <typename V>
+inline DD<V> two_prod(V a, V b)
+{
+    // Algorithm 3 without FMA: cost 17 flops.  Overflow is rare, so we fix
+    // up the lanes concerned one by one.
+    V pi = a * b;
+    V rho = dekker_error(a, b, pi);
+    if (!all_finite(rho)) {
+        double as[V::width], bs[V::width], pis[V::width], rhos[V::width];
+        V::store(as, a);
+        V::store(bs, b);
+        V::store(pis, pi);
+        V::store(rhos, rho);
+        for (size_t i = 0; i != V::width; ++i)
+            rhos[i] = scaled_dekker_error(as[i], bs[i], pis[i], rhos[i]);
+        rho = V::load(rhos);
+    }
+    return {pi, rho};
+}
+
+#endif
+
+template <typename V>
+inline DD<V> neg(DD<V> x)
+{
+    return {neg(x.hi), neg(x.lo)};
+}
+
+template <typename V>
+inline DD<V> add(DD<V> x, DD<V> y)
+{
+    // Algorithm 6: cost 20 flops, error 3 u^2 + 13 u^3
+    DD<V> s = two_sum(x.hi, y.hi);
+    DD<V> t = two_sum(x.lo, y.lo);
+    V c = s.lo + t.hi;
+    DD<V> v = fast_two_sum(s.hi, c);
+    V w = t.lo + v.lo;
+    return fast_two_sum(v.hi, w);
+}
+
+template <typename V>
+inline DD<V> mul(DD<V> x, DD<V> y)
+{
+    DD<V> c = two_prod(x.hi, y.hi);
+#if XPREC_USE_FMA
+    // Algorithm 12: cost 9 flops, error 4 u^2 (corrected)
+    V tl0 = x.lo * y.lo;
+    V tl1 = fmadd(x.hi, y.lo, tl0);
+    V cl2 = fmadd(x.lo, y.hi, tl1);
+#else
+    // Algorithm 10: cost 24 flops, error 7 u^2
+    V tl1 = x.hi * y.lo;
+    V tl2 = x.lo * y.hi;
+    V cl2 = tl1 + tl2;
+#endif
+    V cl3 = c.lo + cl2;
+    return fast_two_sum(c.hi, cl3);
+}
+
+template <typename V>
+inline DD<V> add_small(V x, DD<V> y)
+{
+    // Algorithm 4 modified: cost 7 flops, error 2 u^2
+    DD<V> s = fast_two_sum(x, y.hi);
+    V v = y.lo + s.lo;
+    return fast_two_sum(s.hi, v);
+}
+
+template <typename V>
+inline DD<V> mul(DD<V> x, V y)
+{
+    DD<V> c = two_prod(x.hi, y);
+#if XPREC_USE_FMA
+    // Algorithm 9: cost 6 flops, error 2 u^2
+    V cl3 = fmadd(x.lo, y, c.lo);
+#else
+    // Algorithm 8: cost 22 flops, error 3 u^2
+    V cl2 = x.lo * y;
+    V cl3 = c.lo + cl2;
+#endif
+    return fast_two_sum(c.hi, cl3);
+}
+
+template <typename V>
+inline DD<V> reciprocal(DD<V> y)
+{
+    // Part of Algorithm 18 with second-order term: cost 23 flops, error 2 u^2
+    V th = V::broadcast(1.0) / y.hi;
+#if XPREC_USE_FMA
+    V rh = fmadd(neg(y.hi), th, V::broadcast(1.0));
+#else
+    // The remainder is computed using Dekker's product.  The subtractions
+    // are exact, so this gives the same result.
+    DD<V> p = two_prod(y.hi, th);
+    V rh = (V::broadcast(1.0) - p.hi) - p.lo;
+#endif
+    V rl = neg(y.lo) * th;
+    DD<V> e = two_sum(rh, rl);
+#if XPREC_USE_FMA
+    e.lo = fmadd(e.hi, e.hi, e.lo);
+#else
+    e.lo = e.lo + e.hi * e.hi;
+#endif
+    DD<V> delta = mul(e, th);
+    return add_small(th, delta);
+}
+
+// -------------------------------------------------------------------------
+// Loop drivers
+
+/**
+ * Apply op elementwise to x, storing the result in out.
+ *
+ * Full chunks of V::width elements are processed with type V, the remainder
+ * element by element with type Scalar.
+ */
+template <typename V, typename Op>
+inline void unary_loop(Op op, size_t n, const double *xhi, const double *xlo,
+                       double *outhi, double *outlo)
+{
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        DD<V> xi = DD<V>::load(xhi + i, xlo + i);
+        DD<V>::store(outhi + i, outlo + i, op(xi));
+    }
+    for (; i != n; ++i) {
+        DD<Scalar> xi = DD<Scalar>::load(xhi + i, xlo + i);
+        DD<Scalar>::store(outhi + i, outlo + i, op(xi));
+    }
+}
+
+/** Apply op elementwise to x and y, storing the result in out. */
+template <typename V, typename Op>
+inline void binary_loop(Op op, size_t n, const double *xhi, const double *xlo,
+                        const double *yhi, const double *ylo, double *outhi,
+                        double *outlo)
+{
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        DD<V> xi = DD<V>::load(xhi + i, xlo + i);
+        DD<V> yi = DD<V>::load(yhi + i, ylo + i);
+        DD<V>::store(outhi + i, outlo + i, op(xi, yi));
+    }
+    for (; i != n; ++i) {
+        DD<Scalar> xi = DD<Scalar>::load(xhi + i, xlo + i);
+        DD<Scalar> yi = DD<Scalar>::load(yhi + i, ylo + i);
+        DD<Scalar>::store(outhi + i, outlo + i, op(xi, yi));
+    }
+}
+
+struct AddOp {
+    template <typename V>
+    DD<V> operator()(DD<V> x, DD<V> y) const { return add(x, y); }
+};
+
+struct SubOp {
+    template <typename V>
+    DD<V> operator()(DD<V> x, DD<V> y) const { return add(x, neg(y)); }
+};
+
+struct MulOp {
+    template <typename V>
+    DD<V> operator()(DD<V> x, DD<V> y) const { return mul(x, y); }
+};
+
+struct ScaleOp {
+    double ahi, alo;
+
+    template <typename V>
+    DD<V> operator()(DD<V> x) const
+    {
+        return mul(DD<V>::broadcast(ahi, alo), x);
+    }
+};
+
+struct AxpyOp {
+    double ahi, alo;
+
+    template <typename V>
+    DD<V> operator()(DD<V> x, DD<V> y) const
+    {
+        return add(mul(DD<V>::broadcast(ahi, alo), x), y);
+    }
+};
+
+struct DivOp {
+    template <typename V>
+    DD<V> operator()(DD<V> x, DD<V> y) const
+    {
+        // Algorithm 18: cost 32 flops, error 6 u^2 (4 u^2 obs.)
+        return mul(x, reciprocal(y));
+    }
+};
+
+struct ReciprocalOp {
+    template <typename V>
+    DD<V> operator()(DD<V> x) const { return reciprocal(x); }
+};
+
+struct ScaleRightOp {
+    double ahi, alo;
+
+    template <typename V>
+    DD<V> operator()(DD<V> x) const
+    {
+        return mul(x, DD<V>::broadcast(ahi, alo));
+    }
+};
+
+/** Apply op elementwise to the strided x, storing the result in place. */
+template <typename V, typename Op>
+inline void strided_unary_loop(Op op, size_t n, double *xhi, double *xlo,
+                               size_t incx)
+{
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        size_t ix = i * incx;
+        DD<V> xi = DD<V>::load(xhi + ix, xlo + ix, incx);
+        DD<V>::store(xhi + ix, xlo + ix, incx, op(xi));
+    }
+    for (; i != n; ++i) {
+        size_t ix = i * incx;
+        DD<Scalar> xi = DD<Scalar>::load(xhi + ix, xlo + ix);
+        DD<Scalar>::store(xhi + ix, xlo + ix, op(xi));
+    }
+}
+
+/** Apply op elementwise to the strided x and y, storing the result in y. */
+template <typename V, typename Op>
+inline void strided_binary_loop(Op op, size_t n, const double *xhi,
+                                const double *xlo, size_t incx, double *yhi,
+                                double *ylo, size_t incy)
+{
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        size_t ix = i * incx, iy = i * incy;
+        DD<V> xi = DD<V>::load(xhi + ix, xlo + ix, incx);
+        DD<V> yi = DD<V>::load(yhi + iy, ylo + iy, incy);
+        DD<V>::store(yhi + iy, ylo + iy, incy, op(xi, yi));
+    }
+    for (; i != n; ++i) {
+        size_t ix = i * incx, iy = i * incy;
+        DD<Scalar> xi = DD<Scalar>::load(xhi + ix, xlo + ix);
+        DD<Scalar> yi = DD<Scalar>::load(yhi + iy, ylo + iy);
+        DD<Scalar>::store(yhi + iy, ylo + iy, op(xi, yi));
+    }
+}
+
+/**
+ * Lazily normalized sum of double-doubles.
+ *
+ * Sums the hi parts of the terms using two_sum(), but merely adds up the
+ * rounding errors and lo parts in a double.  This costs 9 flops per term
+ * instead of 20 flops for add(), and shortens the dependency chain.  Every
+ * RENORM terms, the partial sum is normalized and added to the total, which
+ * bounds the error at about 2 RENORM (RENORM + 2) u^2 times the sum of the
+ * magnitudes of the terms plus 3 u^2 per renormalization.
+ */
+template <typename V>
+struct LazySum {
+    static constexpr unsigned RENORM = 8;
+
+    DD<V> total, part;
+    unsigned count;
+
+    LazySum()
+        : total(DD<V>::broadcast(0.0, 0.0))
+        , part(DD<V>::broadcast(0.0, 0.0))
+        , count(0)
+    { }
+
+    void push(DD<V> x)
+    {
+        DD<V> s = two_sum(part.hi, x.hi);
+        part = {s.hi, part.lo + (s.lo + x.lo)};
+        if (++count == RENORM)
+            renormalize();
+    }
+
+    void renormalize()
+    {
+        total = add(total, two_sum(part.hi, part.lo));
+        part = DD<V>::broadcast(0.0, 0.0);
+        count = 0;
+    }
+
+    /** Add the lanes of the result to the scalar sum */
+    DD<Scalar> reduce(DD<Scalar> sum)
+    {
+        renormalize();
+        double hi[V::width], lo[V::width];
+        DD<V>::store(hi, lo, total);
+        for (size_t i = 0; i != V::width; ++i)
+            sum = add(sum, DD<Scalar>::load(hi + i, lo + i));
+        return sum;
+    }
+};
+
+/** Number of independent accumulators in reductions */
+constexpr size_t REDUCE_CHAINS = 4;
+
+/**
+ * Sum term(i) for i in [0, n), storing the result in out[0] and out[1].
+ *
+ * The sum is split into REDUCE_CHAINS accumulators for each lane to hide
+ * the latency of the additions.  The result thus depends on V::width.
+ */
+template <typename V, typename Term>
+inline void reduce_loop(Term term, size_t n, double *out)
+{
+    LazySum<V> acc[REDUCE_CHAINS];
+    size_t i = 0;
+    for (; i + REDUCE_CHAINS * V::width <= n; i += REDUCE_CHAINS * V::width) {
+        for (size_t k = 0; k != REDUCE_CHAINS; ++k)
+            acc[k].push(term.template get<V>(i + k * V::width));
+    }
+    for (; i + V::width <= n; i += V::width)
+        acc[0].push(term.template get<V>(i));
+
+    LazySum<Scalar> rest;
+    for (; i != n; ++i)
+        rest.push(term.template get<Scalar>(i));
+
+    DD<Scalar> sum = rest.reduce(DD<Scalar>::broadcast(0.0, 0.0));
+    for (size_t k = 0; k != REDUCE_CHAINS; ++k)
+        sum = acc[k].reduce(sum);
+    DD<Scalar>::store(out, out + 1, sum);
+}
+
+struct DotTerm {
+    const double *xhi, *xlo;
+    size_t incx;
+    const double *yhi, *ylo;
+    size_t incy;
+
+    template <typename V>
+    DD<V> get(size_t i) const
+    {
+        // Cost 9 flops.  The product of the lo parts is below the error.
+        DD<V> x = DD<V>::load(xhi + i * incx, xlo + i * incx, incx);
+        DD<V> y = DD<V>::load(yhi + i * incy, ylo + i * incy, incy);
+        DD<V> p = two_prod(x.hi, y.hi);
+        return {p.hi, x.hi * y.lo + (x.lo * y.hi + p.lo)};
+    }
+};
+
+struct DoubleDotTerm {
+    const double *x, *y;
+
+    template <typename V>
+    DD<V> get(size_t i) const
+    {
+        // Error-free product (cost 2 flops), summed as in Dot2 of Ogita,
+        // Rump and Oishi, SIAM J. Sci. Comput. 26, 1955 (2005)
+        return two_prod(V::load(x + i), V::load(y + i));
+    }
+};
+
+struct SumTerm {
+    const double *xhi, *xlo;
+    size_t incx;
+
+    template <typename V>
+    DD<V> get(size_t i) const
+    {
+        return DD<V>::load(xhi + i * incx, xlo + i * incx, incx);
+    }
+};
+
+struct DoubleSumTerm {
+    const double *x;
+
+    template <typename V>
+    DD<V> get(size_t i) const
+    {
+        return {V::load(x + i), V::broadcast(0.0)};
+    }
+};
+
+struct AbsTerm {
+    const double *xhi, *xlo;
+    size_t incx;
+
+    template <typename V>
+    DD<V> get(size_t i) const
+    {
+        DD<V> x = DD<V>::load(xhi + i * incx, xlo + i * incx, incx);
+        return {flipsign(x.hi, x.hi), flipsign(x.lo, x.hi)};
+    }
+};
+
+struct SquareTerm {
+    double scale;
+    const double *xhi, *xlo;
+    size_t incx;
+
+    template <typename V>
+    DD<V> get(size_t i) const
+    {
+        // Scaling by a power of two is exact (barring underflow)
+        DD<V> x = DD<V>::load(xhi + i * incx, xlo + i * incx, incx);
+        V s = V::broadcast(scale);
+        V xh = x.hi * s, xl = x.lo * s;
+        DD<V> p = two_prod(xh, xh);
+        return {p.hi, (xh + xh) * xl + p.lo};
+    }
+};
+
+/** Maximum of |x[i]|, where NaNs may or may not be ignored */
+template <typename V>
+inline double abs_max_loop(size_t n, const double *x, size_t incx)
+{
+    V acc = V::broadcast(0.0);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V xi = incx == 1 ? V::load(x + i) : V::gather(x + i * incx, incx);
+        acc = max(acc, flipsign(xi, xi));
+    }
+
+    double lanes[V::width];
+    V::store(lanes, acc);
+    double result = 0.0;
+    for (size_t k = 0; k != V::width; ++k)
+        result = lanes[k] > result ? lanes[k] : result;
+    for (; i != n; ++i) {
+        double xi = std::fabs(x[i * incx]);
+        result = xi > result ? xi : result;
+    }
+    return result;
+}
+
+/** Call fn(term) with the terms described by args */
+template <typename Fn>
+inline void visit_terms(const TermArgs &args, Fn fn)
+{
+    switch (args.kind) {
+    case TermArgs::SUM:
+        fn(SumTerm{args.xhi, args.xlo, args.incx});
+        break;
+    case TermArgs::SUM_DOUBLE:
+        fn(DoubleSumTerm{args.xhi});
+        break;
+    case TermArgs::DOT:
+        fn(DotTerm{args.xhi, args.xlo, args.incx, args.yhi, args.ylo,
+                   args.incy});
+        break;
+    case TermArgs::DOT_DOUBLE:
+        fn(DoubleDotTerm{args.xhi, args.yhi});
+        break;
+    }
+}
+
+/**
+ * Largest magnitude, sum and non-finite flag of the hi parts of terms.
+ *
+ * The flag is the sum of x * 0, which is NaN if any term is infinite or NaN
+ * (and zero otherwise), since max() need not propagate NaNs.
+ */
+template <typename V>
+struct TermStats {
+    V amax, total, flag;
+
+    TermStats()
+        : amax(V::broadcast(0.0))
+        , total(V::broadcast(0.0))
+        , flag(V::broadcast(0.0))
+    { }
+
+    void push(V x)
+    {
+        amax = max(amax, flipsign(x, x));
+        total = total + x;
+        flag = flag + x * V::broadcast(0.0);
+    }
+
+    /** Merge lanes into out[0] (maximum), out[1] (sum) and out[2] (flag) */
+    void reduce(double *out) const
+    {
+        double a[V::width], t[V::width], f[V::width];
+        V::store(a, amax);
+        V::store(t, total);
+        V::store(f, flag);
+        for (size_t i = 0; i != V::width; ++i) {
+            out[0] = a[i] > out[0] ? a[i] : out[0];
+            out[1] += t[i];
+            out[2] += f[i];
+        }
+    }
+};
+
+template <typename V>
+struct TermStatsLoop {
+    size_t begin, end;
+    double *out;
+
+    template <typename Term>
+    void operator()(Term term) const
+    {
+        TermStats<V> acc;
+        size_t i = begin;
+        for (; i + V::width <= end; i += V::width)
+            acc.push(term.template get<V>(i).hi);
+
+        TermStats<Scalar> rest;
+        for (; i != end; ++i)
+            rest.push(term.template get<Scalar>(i).hi);
+
+        acc.reduce(out);
+        rest.reduce(out);
+    }
+};
+
+/**
+ * Binned sum of terms, as in Demmel and Nguyen, IEEE Trans. Comput. 64,
+ * 2060 (2015).
+ *
+ * For each level k, adding and subtracting m[k] = 1.5 * 2^E[k] rounds a
+ * value to a multiple of ulp(m[k]) without error, provided it is below
+ * 2^(E[k]-2) in magnitude.  The rounded slices are summed exactly, as long
+ * as the bins do not overflow, and the remainders are passed to the next
+ * level.  Since no sum is rounded, the result is independent of the order
+ * of the terms, the lanes, and how the terms are split across calls.  The
+ * hi part of each term enters at level 0, the lo part at level 1.
+ */
+template <typename V>
+struct BinnedSumLoop {
+    size_t begin, end;
+    double scale;
+    const double *m;
+    size_t levels;
+    double *sums;
+
+    template <typename W>
+    void push(DD<W> x, const W *mv, W *acc) const
+    {
+        W s = W::broadcast(scale);
+        W hi = x.hi * s, lo = x.lo * s;
+        W q = (mv[0] + hi) - mv[0];
+        acc[0] = acc[0] + q;
+        hi = hi - q;
+        for (size_t k = 1; k != levels; ++k) {
+            W qhi = (mv[k] + hi) - mv[k];
+            W qlo = (mv[k] + lo) - mv[k];
+            acc[k] = (acc[k] + qhi) + qlo;
+            hi = hi - qhi;
+            lo = lo - qlo;
+        }
+    }
+
+    template <typename W, typename Term>
+    size_t run(Term term, size_t i, size_t stop) const
+    {
+        W mv[BINNED_MAX_LEVELS], acc[BINNED_MAX_LEVELS];
+        for (size_t k = 0; k != levels; ++k) {
+            mv[k] = W::broadcast(m[k]);
+            acc[k] = W::broadcast(0.0);
+        }
+        for (; i + W::width <= stop; i += W::width)
+            push(term.template get<W>(i), mv, acc);
+
+        // Exact, so the lanes can be added in any order
+        for (size_t k = 0; k != levels; ++k) {
+            double lanes[W::width];
+            W::store(lanes, acc[k]);
+            for (size_t j = 0; j != W::width; ++j)
+                sums[k] += lanes[j];
+        }
+        return i;
+    }
+
+    template <typename Term>
+    void operator()(Term term) const
+    {
+        assert(levels >= 1 && levels <= BINNED_MAX_LEVELS);
+        size_t i = run<V>(term, begin, end);
+        run<Scalar>(term, i, end);
+    }
+};
+
+/**
+ * Register-blocked gemm micro-kernel: C += A * B for one tile.
+ *
+ * A is a packed panel of V::width rows and B a packed panel of GEMM_NR
+ * columns, each storing the hi parts followed by the lo parts for every p.
+ * The tile of C is held in structure-of-arrays form, column by column.
+ */
+template <typename V>
+inline void gemm_micro(size_t kc, const double *a, const double *b,
+                       double *chi, double *clo)
+{
+    const size_t mr = V::width;
+    DD<V> acc[GEMM_NR];
+    for (size_t j = 0; j != GEMM_NR; ++j)
+        acc[j] = DD<V>::load(chi + j * mr, clo + j * mr);
+
+    for (size_t p = 0; p != kc; ++p) {
+        DD<V> ap = DD<V>::load(a, a + mr);
+        for (size_t j = 0; j != GEMM_NR; ++j) {
+            DD<V> bpj = DD<V>::broadcast(b[j], b[GEMM_NR + j]);
+            acc[j] = add(acc[j], mul(ap, bpj));
+        }
+        a += 2 * mr;
+        b += 2 * GEMM_NR;
+    }
+
+    for (size_t j = 0; j != GEMM_NR; ++j)
+        DD<V>::store(chi + j * mr, clo + j * mr, acc[j]);
+}
+
+/**
+ * Update mc x nc block of C with the product of packed blocks of A and B.
+ *
+ * C is stored column-major as interleaved hi and lo parts with a leading
+ * dimension of ldc double-doubles.  Each tile of C is copied to and from
+ * a buffer, which takes care of partial tiles at the edges, where the packed
+ * blocks are padded with zeros.
+ */
+template <typename V>
+inline void gemm_block(size_t mc, size_t nc, size_t kc, const double *apack,
+                       const double *bpack, double *c, size_t ldc)
+{
+    const size_t mr = V::width, nr = GEMM_NR;
+    double chi[mr * nr], clo[mr * nr];
+
+    for (size_t jr = 0; jr < nc; jr += nr) {
+        const size_t nt = nc - jr < nr ? nc - jr : nr;
+        const double *b = bpack + jr * 2 * kc;
+
+        for (size_t ir = 0; ir < mc; ir += mr) {
+            const size_t mt = mc - ir < mr ? mc - ir : mr;
+            const double *a = apack + ir * 2 * kc;
+
+            for (size_t j = 0; j != nr; ++j) {
+                for (size_t i = 0; i != mr; ++i) {
+                    const double *cij = c + 2 * (ir + i + (jr + j) * ldc);
+                    bool inside = i < mt && j < nt;
+                    chi[j * mr + i] = inside ? cij[0] : 0.0;
+                    clo[j * mr + i] = inside ? cij[1] : 0.0;
+                }
+            }
+
+            gemm_micro<V>(kc, a, b, chi, clo);
+
+            for (size_t j = 0; j != nt; ++j) {
+                for (size_t i = 0; i != mt; ++i) {
+                    double *cij = c + 2 * (ir + i + (jr + j) * ldc);
+                    cij[0] = chi[j * mr + i];
+                    cij[1] = clo[j * mr + i];
+                }
+            }
+        }
+    }
+}
+
+/** Kernels for vector type V */
+template <typename V>
+struct KernelsFor {
+    static void add(size_t n, const double *xhi, const double *xlo,
+                    const double *yhi, const double *ylo, double *outhi,
+                    double *outlo)
+    {
+        binary_loop<V>(AddOp(), n, xhi, xlo, yhi, ylo, outhi, outlo);
+    }
+
+    static void sub(size_t n, const double *xhi, const double *xlo,
+                    const double *yhi, const double *ylo, double *outhi,
+                    double *outlo)
+    {
+        binary_loop<V>(SubOp(), n, xhi, xlo, yhi, ylo, outhi, outlo);
+    }
+
+    static void mul(size_t n, const double *xhi, const double *xlo,
+                    const double *yhi, const double *ylo, double *outhi,
+                    double *outlo)
+    {
+        binary_loop<V>(MulOp(), n, xhi, xlo, yhi, ylo, outhi, outlo);
+    }
+
+    static void div(size_t n, const double *xhi, const double *xlo,
+                    const double *yhi, const double *ylo, double *outhi,
+                    double *outlo)
+    {
+        binary_loop<V>(DivOp(), n, xhi, xlo, yhi, ylo, outhi, outlo);
+    }
+
+    static void scale(double ahi, double alo, size_t n, const double *xhi,
+                      const double *xlo, double *outhi, double *outlo)
+    {
+        unary_loop<V>(ScaleOp{ahi, alo}, n, xhi, xlo, outhi, outlo);
+    }
+
+    static void scale_right(double ahi, double alo, size_t n,
+                            const double *xhi, const double *xlo,
+                            double *outhi, double *outlo)
+    {
+        unary_loop<V>(ScaleRightOp{ahi, alo}, n, xhi, xlo, outhi, outlo);
+    }
+
+    static void reciprocal(size_t n, const double *xhi, const double *xlo,
+                           double *outhi, double *outlo)
+    {
+        unary_loop<V>(ReciprocalOp(), n, xhi, xlo, outhi, outlo);
+    }
+
+    static void axpy(double ahi, double alo, size_t n, const double *xhi,
+                     const double *xlo, double *yhi, double *ylo)
+    {
+        binary_loop<V>(AxpyOp{ahi, alo}, n, xhi, xlo, yhi, ylo, yhi, ylo);
+    }
+
+    static void dot(size_t n, const double *xhi, const double *xlo,
+                    size_t incx, const double *yhi, const double *ylo,
+                    size_t incy, double *out)
+    {
+        reduce_loop<V>(DotTerm{xhi, xlo, incx, yhi, ylo, incy}, n, out);
+    }
+
+    static void dot2(size_t n, const double *x, const double *y, double *out)
+    {
+        reduce_loop<V>(DoubleDotTerm{x, y}, n, out);
+    }
+
+    static void sum(size_t n, const double *xhi, const double *xlo,
+                    size_t incx, double *out)
+    {
+        reduce_loop<V>(SumTerm{xhi, xlo, incx}, n, out);
+    }
+
+    static void sum_double(size_t n, const double *x, double *out)
+    {
+        reduce_loop<V>(DoubleSumTerm{x}, n, out);
+    }
+
+    static void asum(size_t n, const double *xhi, const double *xlo,
+                     size_t incx, double *out)
+    {
+        reduce_loop<V>(AbsTerm{xhi, xlo, incx}, n, out);
+    }
+
+    static void sum_squares(double scale, size_t n, const double *xhi,
+                            const double *xlo, size_t incx, double *out)
+    {
+        reduce_loop<V>(SquareTerm{scale, xhi, xlo, incx}, n, out);
+    }
+
+    static double abs_max(size_t n, const double *x, size_t incx)
+    {
+        return abs_max_loop<V>(n, x, incx);
+    }
+
+    static void term_stats(const TermArgs &terms, size_t begin, size_t end,
+                           double *out)
+    {
+        visit_terms(terms, TermStatsLoop<V>{begin, end, out});
+    }
+
+    static void binned_sum(const TermArgs &terms, size_t begin, size_t end,
+                           double scale, const double *m, size_t levels,
+                           double *sums)
+    {
+        visit_terms(terms,
+                    BinnedSumLoop<V>{begin, end, scale, m, levels, sums});
+    }
+
+    static void axpy_strided(double ahi, double alo, size_t n,
+                             const double *xhi, const double *xlo,
+                             size_t incx, double *yhi, double *ylo,
+                             size_t incy)
+    {
+        strided_binary_loop<V>(AxpyOp{ahi, alo}, n, xhi, xlo, incx, yhi, ylo,
+                               incy);
+    }
+
+    static void scale_strided(double ahi, double alo, size_t n, double *xhi,
+                              double *xlo, size_t incx)
+    {
+        strided_unary_loop<V>(ScaleOp{ahi, alo}, n, xhi, xlo, incx);
+    }
+
+    static void gemm(size_t mc, size_t nc, size_t kc, const double *apack,
+                     const double *bpack, double *c, size_t ldc)
+    {
+        gemm_block<V>(mc, nc, kc, apack, bpack, c, ldc);
+    }
+
+    static constexpr Kernels table()
+    {
+        static_assert(V::width <= GEMM_MAX_MR, "increase GEMM_MAX_MR");
+        return {&KernelsFor::add,   &KernelsFor::sub,
+                &KernelsFor::mul,   &KernelsFor::div,
+                &KernelsFor::scale, &KernelsFor::scale_right,
+                &KernelsFor::axpy,  &KernelsFor::reciprocal,
+                &KernelsFor::dot,   &KernelsFor::dot2,
+                &KernelsFor::sum,   &KernelsFor::sum_double,
+                &KernelsFor::asum,
+                &KernelsFor::sum_squares,
+                &KernelsFor::abs_max,
+                &KernelsFor::term_stats,
+                &KernelsFor::binned_sum,
+                &KernelsFor::axpy_strided,
+                &KernelsFor::scale_strided,
+                V::width,           &KernelsFor::gemm};
+    }
+};
+
+} // namespace
+} // namespace _simd
+} // namespace xprec
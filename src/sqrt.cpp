@@ -31,7 +31,8 @@ DDouble sqrt(DDouble a)
     //   x  = x + 0.5 * x * (1.0 - A * x * x)
     //
     double x0_half = 0.5 / y0;
-    double delta_y = x0_half * (std::fma(-y0, y0, a.hi()) + a.lo());
+    double r0 = _internal::exact_remainder(y0, y0, a.hi());
+    double delta_y = x0_half * (r0 + a.lo());
 
     // We would like to do DDouble(y0, delta_y), however, delta_y may alter
     // the least significant digit of y0.
@@ -49,8 +50,8 @@ DDouble hypot(DDouble x, DDouble y)
     }
 
     // Check for infinities
-    if (!std::isfinite(x.hi())) {
-        return std::isnan(y.hi()) ? y : x;
+    if (!_internal::is_finite(x.hi())) {
+        return _internal::is_nan(y.hi()) ? y : x;
     }
 
     // Splits the range in half
@@ -0,0 +1,68 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "catch2-addons.hpp"
+#include "mpfloat.hpp"
+#include "xprec/accumulator.hpp"
+#include "xprec/ddouble.hpp"
+#include "xprec/random.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+using xprec::Accumulator;
+using xprec::DDouble;
+
+TEST_CASE("accumulator sum", "[accumulator]")
+{
+    const double u = 0.5 * std::numeric_limits<double>::epsilon();
+    std::mt19937 rng;
+    std::uniform_real_distribution<DDouble> dist(-1.0, 1.0);
+
+    for (size_t n : {0, 1, 7, 8, 9, 100, 1000}) {
+        Accumulator acc(0.25);
+        MPFloat ref = 0.25, ref_abs = 0.25;
+        for (size_t i = 0; i != n; ++i) {
+            DDouble x = ldexp(dist(rng), int(i % 7) - 3);
+            double y = dist(rng).hi();
+            switch (i % 4) {
+            case 0:
+                acc += x;
+                ref += MPFloat(x);
+                ref_abs += abs(MPFloat(x));
+                break;
+            case 1:
+                acc -= y;
+                ref -= y;
+                ref_abs += abs(MPFloat(y));
+                break;
+            case 2:
+                acc.add_product(x, y);
+                ref += MPFloat(x) * y;
+                ref_abs += abs(MPFloat(x) * y);
+                break;
+            default:
+                acc.add_product(x, x);
+                ref += MPFloat(x) * MPFloat(x);
+                ref_abs += MPFloat(x) * MPFloat(x);
+                break;
+            }
+        }
+        DDouble tol = (164.0 + n / 2.0) * u * u * ref_abs.as_ddouble();
+        REQUIRE_THAT(acc.value(), WithinAbs(ref.as_ddouble(), tol));
+
+        // Reading does not change the value
+        DDouble r = acc.value();
+        acc.normalize();
+        REQUIRE(DDouble(acc) == r);
+    }
+}
+
+TEST_CASE("accumulator dot2", "[accumulator]")
+{
+    // Exact products survive cancellation
+    Accumulator acc;
+    acc.add_product(1 + 0x1p-30, 1 - 0x1p-30);
+    acc -= 1.0;
+    REQUIRE(acc.value() == -0x1p-60);
+}
@@ -0,0 +1,259 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "catch2-addons.hpp"
+#include "mpfloat.hpp"
+#include "xprec/array.hpp"
+#include "xprec/ddouble.hpp"
+#include "xprec/random.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using xprec::ConstDDoubleSpan;
+using xprec::DDouble;
+using xprec::DDoubleArray;
+using xprec::DDoubleSpan;
+
+TEST_CASE("construct", "[array]")
+{
+    DDoubleArray empty;
+    REQUIRE(empty.size() == 0);
+    REQUIRE(empty.empty());
+
+    DDoubleArray a(13, DDouble(1.0, ldexp(1.0, -60)));
+    REQUIRE(a.size() == 13);
+    REQUIRE(a.capacity() >= 13);
+    for (size_t i = 0; i != a.size(); ++i) {
+        REQUIRE(a.hi()[i] == 1.0);
+        REQUIRE(a.lo()[i] == ldexp(1.0, -60));
+    }
+
+    DDoubleArray b = {1.0, 2.0, DDouble(3.0, 1e-20)};
+    REQUIRE(b.size() == 3);
+    REQUIRE(b[2] == DDouble(3.0, 1e-20));
+
+    std::vector<DDouble> v = {5.0, -1.0};
+    DDoubleArray c(v.data(), v.data() + v.size());
+    REQUIRE(c.size() == 2);
+    REQUIRE(c[0] == 5.0);
+    REQUIRE(c[1] == -1.0);
+}
+
+TEST_CASE("alignment", "[array]")
+{
+    for (size_t n = 1; n != 40; ++n) {
+        DDoubleArray a(n);
+        REQUIRE(reinterpret_cast<uintptr_t>(a.hi()) % 64 == 0);
+        REQUIRE(reinterpret_cast<uintptr_t>(a.lo()) % 64 == 0);
+    }
+}
+
+TEST_CASE("copy and resize", "[array]")
+{
+    DDoubleArray a = {1.0, 2.0, 3.0};
+    DDoubleArray b = a;
+    b[0] = 4.0;
+    REQUIRE(a[0] == 1.0);
+    REQUIRE(b[0] == 4.0);
+
+    b.resize(100, 7.0);
+    REQUIRE(b.size() == 100);
+    REQUIRE(b[1] == 2.0);
+    REQUIRE(b[99] == 7.0);
+
+    a = b;
+    REQUIRE(a.size() == 100);
+    REQUIRE(a[0] == 4.0);
+
+    DDoubleArray c = std::move(b);
+    REQUIRE(c.size() == 100);
+    REQUIRE(b.size() == 0);
+}
+
+TEST_CASE("proxy", "[array]")
+{
+    DDoubleArray a(4, 1.0);
+
+    // Code written against DDouble should work with the proxy
+    a[0] += DDouble(1.0, 1e-20);
+    a[1] *= 3.0;
+    a[2] = -a[1] + a[0];
+    a[3] = 2.0 * a[0] + sqrt(a[1]) - 1.0;
+    REQUIRE(a[0] == DDouble(2.0, 1e-20));
+    REQUIRE(a[1] == 3.0);
+    REQUIRE(a[2] == DDouble(-1.0, 1e-20));
+    REQUIRE(a[0] > a[1] - 1.5);
+
+    DDouble x = a[3];
+    REQUIRE(x == 2.0 * DDouble(2.0, 1e-20) + sqrt(DDouble(3.0)) - 1.0);
+
+    swap(a[0], a[1]);
+    REQUIRE(a[0] == 3.0);
+    REQUIRE(a[1] == DDouble(2.0, 1e-20));
+}
+
+TEST_CASE("span", "[array]")
+{
+    DDoubleArray a(10);
+    DDoubleSpan s = a;
+    s.subspan(5, 5).fill(2.0);
+    REQUIRE(a[4] == 0.0);
+    REQUIRE(a[5] == 2.0);
+
+    ConstDDoubleSpan cs = s;
+    DDouble sum = 0.0;
+    for (DDouble x : cs)
+        sum += x;
+    REQUIRE(sum == 10.0);
+
+    for (auto x : a)
+        x = 1.0;
+    REQUIRE(std::count(a.begin(), a.end(), DDouble(1.0)) == 10);
+}
+
+static DDoubleArray random_array(size_t n, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<DDouble> dist(-1.0, 1.0);
+    DDoubleArray a(n);
+    for (size_t i = 0; i != n; ++i)
+        a[i] = ldexp(dist(rng), int(i % 7) - 3);
+    return a;
+}
+
+static bool identical(DDouble x, DDouble y)
+{
+    return x.hi() == y.hi() && x.lo() == y.lo()
+           && std::signbit(x.hi()) == std::signbit(y.hi());
+}
+
+static void check_elementwise()
+{
+    std::mt19937 rng;
+    for (size_t n = 0; n != 37; ++n) {
+        DDoubleArray x = random_array(n, rng);
+        DDoubleArray y = random_array(n, rng);
+        DDoubleArray r(n);
+        DDouble a = DDouble(0.3, 1e-18);
+
+        xprec::add(x, y, r);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(r[i], x[i] + y[i]));
+
+        xprec::sub(x, y, r);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(r[i], x[i] - y[i]));
+
+        xprec::mul(x, y, r);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(r[i], x[i] * y[i]));
+
+        xprec::div(x, y, r);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(r[i], x[i] / y[i]));
+
+        xprec::div(x, a, r);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(r[i], x[i] / a));
+
+        xprec::reciprocal(y, r);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(r[i], reciprocal(y[i])));
+
+        xprec::mul(a, x, r);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(r[i], a * x[i]));
+
+        DDoubleArray z = y;
+        xprec::axpy(a, x, z);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(z[i], a * x[i] + y[i]));
+
+        // Output may alias the input
+        z = x;
+        xprec::mul(z, z, z);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(z[i], x[i] * x[i]));
+
+        // Without FMA, Dekker's product must be rescaled close to overflow
+        for (size_t i = 0; i != n; ++i)
+            z[i] = ldexp(x[i], 1000);
+        xprec::mul(z, y, r);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(r[i], z[i] * y[i]));
+    }
+}
+
+TEST_CASE("elementwise", "[array]")
+{
+    using xprec::SimdLevel;
+    SimdLevel orig = xprec::simd_level();
+
+    SECTION("scalar") {
+        REQUIRE(xprec::set_simd_level(SimdLevel::SCALAR) == SimdLevel::SCALAR);
+        check_elementwise();
+    }
+    SECTION("avx2") {
+        xprec::set_simd_level(SimdLevel::AVX2);
+        check_elementwise();
+    }
+    SECTION("avx512") {
+        xprec::set_simd_level(SimdLevel::AVX512);
+        check_elementwise();
+    }
+    xprec::set_simd_level(orig);
+}
+
+TEST_CASE("reciprocal_batch", "[array]")
+{
+    const double u = 0.5 * std::numeric_limits<double>::epsilon();
+    const double eps = (8 * (xprec::RECIPROCAL_BATCH_SEGMENT - 1) + 2) * u * u;
+    std::mt19937 rng;
+
+    for (size_t n = 0; n != 37; ++n) {
+        DDoubleArray x = random_array(n, rng);
+        DDoubleArray r(n);
+        xprec::reciprocal_batch(x, r);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE_THAT(DDouble(r[i]), WithinRel(1 / MPFloat(DDouble(x[i])), eps));
+
+        // Output may alias the input
+        DDoubleArray z = x;
+        xprec::reciprocal_batch(z, z);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE(identical(z[i], r[i]));
+    }
+
+    // Products of these leave the representable range
+    DDoubleArray big(20), small(20);
+    for (size_t i = 0; i != 20; ++i) {
+        big[i] = DDouble(1e200, 1e183) * (i + 1);
+        small[i] = DDouble(1e-200, 1e-217) / (i + 1);
+    }
+    small[3] = ldexp(DDouble(1.0), -1000);
+    DDoubleArray r(20);
+    xprec::reciprocal_batch(big, r);
+    for (size_t i = 0; i != 20; ++i)
+        REQUIRE_THAT(DDouble(r[i]), WithinRel(1 / MPFloat(DDouble(big[i])), eps));
+    xprec::reciprocal_batch(small, r);
+    for (size_t i = 0; i != 20; ++i)
+        REQUIRE_THAT(DDouble(r[i]), WithinRel(1 / MPFloat(DDouble(small[i])), eps));
+
+    // Special values
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    DDoubleArray s = {2.0, 0.0, -0.0, inf, 4.0, -inf, nan, 0.5};
+    xprec::reciprocal_batch(s, s);
+    REQUIRE(s[0] == 0.5);
+    REQUIRE(s[1] == inf);
+    REQUIRE(s[2] == -inf);
+    REQUIRE(identical(s[3], 0.0));
+    REQUIRE(s[4] == 0.25);
+    REQUIRE(identical(s[5], -0.0));
+    REQUIRE(isnan(s[6]));
+    REQUIRE(s[7] == 2.0);
+}
@@ -0,0 +1,385 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "catch2-addons.hpp"
+#include "mpfloat.hpp"
+#include "xprec/array.hpp"
+#include "xprec/blas.hpp"
+#include "xprec/ddouble.hpp"
+#include "xprec/random.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using xprec::ConstDDoubleSpan;
+using xprec::DDouble;
+using xprec::DDoubleArray;
+using xprec::Transpose;
+
+static std::vector<DDouble> random_matrix(size_t n, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<DDouble> dist(-1.0, 1.0);
+    std::vector<DDouble> a(n);
+    for (size_t i = 0; i != n; ++i)
+        a[i] = ldexp(dist(rng), int(i % 5) - 2);
+    return a;
+}
+
+static bool identical(DDouble x, DDouble y)
+{
+    return x.hi() == y.hi() && x.lo() == y.lo();
+}
+
+static void check_level1(size_t n, size_t inc)
+{
+    const double u = 0.5 * std::numeric_limits<double>::epsilon();
+    const double eps = (160.0 + n / 2.0) * u * u;
+
+    std::mt19937 rng(n * inc);
+    std::vector<DDouble> x = random_matrix(n * inc + 1, rng);
+    std::vector<DDouble> y = random_matrix(n * inc + 1, rng);
+    DDoubleArray xs(n), ys(n);
+    for (size_t i = 0; i != n; ++i) {
+        xs[i] = x[i * inc];
+        ys[i] = y[i * inc];
+    }
+
+    MPFloat dot_ref = 0, sum_ref = 0, asum_ref = 0, nrm2_ref = 0, dot_abs = 0;
+    size_t iamax_ref = 0;
+    for (size_t i = 0; i != n; ++i) {
+        MPFloat xi = DDouble(xs[i]), yi = DDouble(ys[i]);
+        dot_ref += xi * yi;
+        dot_abs += abs(xi * yi);
+        sum_ref += xi;
+        asum_ref += abs(xi);
+        nrm2_ref += xi * xi;
+        if (fabs(xs[i]) > fabs(xs[iamax_ref]))
+            iamax_ref = i;
+    }
+    nrm2_ref = sqrt(nrm2_ref);
+
+    DDouble d = xprec::dot(n, x.data(), inc, y.data(), inc);
+    DDouble dot_tol = eps * dot_abs.as_ddouble();
+    REQUIRE_THAT(d, WithinAbs(dot_ref.as_ddouble(), dot_tol));
+    REQUIRE(identical(d, xprec::dot(xs, ys)));
+
+    DDouble a = xprec::asum(n, x.data(), inc);
+    REQUIRE_THAT(a, WithinRel(asum_ref.as_ddouble(), eps));
+    REQUIRE(identical(a, xprec::asum(xs)));
+
+    DDouble s = xprec::sum(n, x.data(), inc);
+    REQUIRE_THAT(s, WithinAbs(sum_ref.as_ddouble(), eps * a));
+    REQUIRE(identical(s, xprec::sum(xs)));
+
+    DDouble r = xprec::nrm2(n, x.data(), inc);
+    REQUIRE_THAT(r, WithinRel(nrm2_ref.as_ddouble(), eps));
+    REQUIRE(identical(r, xprec::nrm2(xs)));
+
+    REQUIRE(xprec::iamax(n, x.data(), inc) == iamax_ref);
+    REQUIRE(xprec::iamax(xs) == iamax_ref);
+
+    // The updates give the same results as the DDouble operators
+    DDouble alpha(0.3, 1e-18);
+    std::vector<DDouble> z = y;
+    xprec::axpy(n, alpha, x.data(), inc, z.data(), inc);
+    for (size_t i = 0; i != z.size(); ++i) {
+        DDouble expected = i % inc == 0 && i / inc < n ? alpha * x[i] + y[i]
+                                                       : y[i];
+        REQUIRE(identical(z[i], expected));
+    }
+
+    z = x;
+    xprec::scal(n, alpha, z.data(), inc);
+    for (size_t i = 0; i != z.size(); ++i) {
+        DDouble expected = i % inc == 0 && i / inc < n ? alpha * x[i] : x[i];
+        REQUIRE(identical(z[i], expected));
+    }
+}
+
+TEST_CASE("level 1", "[blas]")
+{
+    using xprec::SimdLevel;
+    SimdLevel orig = xprec::simd_level();
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::AVX2,
+                                SimdLevel::AVX512};
+
+    for (SimdLevel level : levels) {
+        xprec::set_simd_level(level);
+        for (size_t n : {0, 1, 7, 33, 100, 2049}) {
+            check_level1(n, 1);
+            check_level1(n, 3);
+        }
+    }
+    xprec::set_simd_level(orig);
+}
+
+static void check_dot2(size_t n)
+{
+    const double u = 0.5 * std::numeric_limits<double>::epsilon();
+    std::mt19937 rng(n);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> x(n), y(n);
+    MPFloat ref = 0, ref_abs = 0, sum_ref = 0, sum_abs = 0;
+    for (size_t i = 0; i != n; ++i) {
+        x[i] = ldexp(dist(rng), int(i % 9) - 4);
+        y[i] = dist(rng);
+        ref += MPFloat(x[i]) * y[i];
+        ref_abs += abs(MPFloat(x[i]) * y[i]);
+        sum_ref += x[i];
+        sum_abs += abs(MPFloat(x[i]));
+    }
+
+    const double eps = (160.0 + n / 2.0) * u * u;
+    REQUIRE_THAT(xprec::dot2(x.data(), y.data(), n),
+                 WithinAbs(ref.as_ddouble(), eps * ref_abs.as_ddouble()));
+    REQUIRE_THAT(xprec::sum(x.data(), n),
+                 WithinAbs(sum_ref.as_ddouble(), eps * sum_abs.as_ddouble()));
+}
+
+TEST_CASE("double vectors", "[blas]")
+{
+    using xprec::SimdLevel;
+    SimdLevel orig = xprec::simd_level();
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::AVX2,
+                            SimdLevel::AVX512}) {
+        xprec::set_simd_level(level);
+        for (size_t n : {0, 1, 3, 16, 31, 32, 100, 4097})
+            check_dot2(n);
+
+        // Cancellation, where a plain double loop gives zero
+        std::vector<double> x(40, 0.0), y(40, 1.0);
+        x[3] = 1e20;
+        x[17] = 3.0;
+        x[38] = -1e20;
+        y[17] = 1.0 / 3.0;
+        DDouble r = xprec::dot2(x.data(), y.data(), x.size());
+        REQUIRE(r.hi() == 1.0);
+
+        x[17] = 0x1p-60;
+        REQUIRE(xprec::sum(x.data(), x.size()) == 0x1p-60);
+    }
+    xprec::set_simd_level(orig);
+}
+
+static void check_reproducible(size_t n, double scale)
+{
+    const double u = 0.5 * std::numeric_limits<double>::epsilon();
+    std::mt19937 rng(n);
+    std::vector<DDouble> xv = random_matrix(n, rng), yv = random_matrix(n, rng);
+    DDoubleArray x(n), y(n);
+    std::vector<double> xd(n);
+    MPFloat sum_ref = 0, dot_ref = 0, dot_abs = 0;
+    double max_dot = 0;
+    for (size_t i = 0; i != n; ++i) {
+        x[i] = xv[i] * scale;
+        y[i] = yv[i];
+        xd[i] = x[i].hi();
+        MPFloat xi = DDouble(x[i]), yi = DDouble(y[i]);
+        sum_ref += xi;
+        dot_ref += xi * yi;
+        dot_abs += abs(xi * yi);
+        max_dot = std::max(max_dot, std::fabs(x[i].hi() * y[i].hi()));
+    }
+
+    DDouble s = xprec::reproducible_sum(x);
+    // Allow for the result to be subnormal
+    DDouble s_tol = (n + 3.0) * u * u * fabs(scale) * 4.0 + 0x1p-1072;
+    REQUIRE_THAT(s, WithinAbs(sum_ref.as_ddouble(), s_tol));
+
+    DDouble d = xprec::reproducible_dot(x, y);
+    DDouble d_tol = (n + 3.0) * u * u * (max_dot + 2 * dot_abs.as_ddouble())
+                    + 0x1p-1072;
+    REQUIRE_THAT(d, WithinAbs(dot_ref.as_ddouble(), d_tol));
+
+    DDouble sd = xprec::reproducible_sum(xd.data(), n);
+    DDouble dd = xprec::reproducible_dot(xd.data(), xd.data(), n);
+
+    // Neither the SIMD level nor the order of the terms matter
+    using xprec::SimdLevel;
+    SimdLevel orig = xprec::simd_level();
+    std::vector<size_t> perm(n);
+    for (size_t i = 0; i != n; ++i)
+        perm[i] = i;
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::AVX2,
+                            SimdLevel::AVX512}) {
+        xprec::set_simd_level(level);
+        std::shuffle(perm.begin(), perm.end(), rng);
+        DDoubleArray xp(n), yp(n);
+        std::vector<double> xdp(n);
+        for (size_t i = 0; i != n; ++i) {
+            xp[i] = x[perm[i]];
+            yp[i] = y[perm[i]];
+            xdp[i] = xd[perm[i]];
+        }
+        REQUIRE(identical(xprec::reproducible_sum(xp), s));
+        REQUIRE(identical(xprec::reproducible_sum(xdp.data(), n), sd));
+
+        // Without FMA, Dekker's product is inexact close to underflow
+        if (XPREC_USE_FMA || fabs(scale) > 0x1p-900) {
+            REQUIRE(identical(xprec::reproducible_dot(xp, yp), d));
+            REQUIRE(identical(
+                    xprec::reproducible_dot(xdp.data(), xdp.data(), n), dd));
+        }
+    }
+    xprec::set_simd_level(orig);
+}
+
+TEST_CASE("reproducible", "[blas]")
+{
+    for (size_t n : {0, 1, 5, 100, 1000})
+        check_reproducible(n, 1.0);
+
+    check_reproducible(77, 0x1p1010);
+    check_reproducible(77, 0x1p-1000);
+    check_reproducible(100000, -3.0);
+
+    // Does not depend on the number of threads
+    std::mt19937 rng;
+    std::vector<DDouble> x = random_matrix(300000, rng);
+    DDoubleArray xs(x.size());
+    for (size_t i = 0; i != x.size(); ++i)
+        xs[i] = x[i];
+
+    xprec::set_gemm_threads(1);
+    DDouble s1 = xprec::reproducible_sum(xs);
+    xprec::set_gemm_threads(3);
+    DDouble s3 = xprec::reproducible_sum(xs);
+    REQUIRE(identical(s1, s3));
+    xprec::set_gemm_threads(0);
+
+    // Cancellation is exact, as long as the result is not too small
+    DDoubleArray c = {0x1p60, DDouble(1.0, 0x1p-80), -0x1p60};
+    REQUIRE(xprec::reproducible_sum(c) == DDouble(1.0, 0x1p-80));
+
+    const double inf = std::numeric_limits<double>::infinity();
+    DDoubleArray special = {1.0, inf, 2.0};
+    REQUIRE(xprec::reproducible_sum(special) == inf);
+    special[0] = -inf;
+    REQUIRE(isnan(xprec::reproducible_sum(special)));
+    REQUIRE(xprec::reproducible_sum(DDoubleArray(3, 0.0)) == 0.0);
+}
+
+TEST_CASE("nrm2 scaling", "[blas]")
+{
+    for (double scale : {1e-300, 1e-160, 1.0, 1e160, 1e300}) {
+        DDoubleArray x = {DDouble(3.0, 1e-17), 4.0, 0.0, -12.0};
+        for (size_t i = 0; i != x.size(); ++i)
+            x[i] = x[i] * scale;
+
+        MPFloat ref = 0;
+        for (size_t i = 0; i != x.size(); ++i)
+            ref += MPFloat(DDouble(x[i])) * MPFloat(DDouble(x[i]));
+        ref = sqrt(ref);
+        CHECK_THAT(xprec::nrm2(x), WithinRel(ref.as_ddouble(), 1e-31));
+    }
+
+    const double inf = std::numeric_limits<double>::infinity();
+    DDoubleArray special = {1.0, inf, 2.0};
+    REQUIRE(xprec::nrm2(special) == inf);
+    special[1] = std::nan("");
+    REQUIRE(isnan(xprec::nrm2(special)));
+    REQUIRE(xprec::nrm2(DDoubleArray(5, 0.0)) == 0.0);
+}
+
+static std::vector<DDouble> naive_gemm(Transpose ta, Transpose tb, size_t m,
+                                       size_t n, size_t k, DDouble alpha,
+                                       const std::vector<DDouble> &a,
+                                       size_t lda,
+                                       const std::vector<DDouble> &b,
+                                       size_t ldb, DDouble beta,
+                                       std::vector<DDouble> c, size_t ldc)
+{
+    for (size_t j = 0; j != n; ++j) {
+        for (size_t i = 0; i != m; ++i) {
+            DDouble &cij = c[i + j * ldc];
+            if (beta != 1.0)
+                cij = beta == 0.0 ? DDouble(0.0) : beta * cij;
+            if (alpha == 0.0)
+                continue;
+
+            for (size_t p = 0; p != k; ++p) {
+                DDouble aip = ta == Transpose::NO ? a[i + p * lda]
+                                                  : a[p + i * lda];
+                DDouble bpj = tb == Transpose::NO ? b[p + j * ldb]
+                                                  : b[j + p * ldb];
+                if (alpha != 1.0)
+                    aip = alpha * aip;
+                cij += aip * bpj;
+            }
+        }
+    }
+    return c;
+}
+
+static void check_gemm(Transpose ta, Transpose tb, size_t m, size_t n,
+                       size_t k, DDouble alpha, DDouble beta)
+{
+    std::mt19937 rng(m * 10007 + n * 101 + k);
+    size_t lda = (ta == Transpose::NO ? m : k) + 3;
+    size_t ldb = (tb == Transpose::NO ? k : n) + 1;
+    size_t ldc = m + 2;
+    size_t acols = ta == Transpose::NO ? k : m;
+    size_t bcols = tb == Transpose::NO ? n : k;
+    std::vector<DDouble> a = random_matrix(lda * acols, rng);
+    std::vector<DDouble> b = random_matrix(ldb * bcols, rng);
+    std::vector<DDouble> c = random_matrix(ldc * n, rng);
+
+    std::vector<DDouble> expected =
+            naive_gemm(ta, tb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+    xprec::gemm(ta, tb, m, n, k, alpha, a.data(), lda, b.data(), ldb, beta,
+                c.data(), ldc);
+    for (size_t i = 0; i != c.size(); ++i)
+        REQUIRE(identical(c[i], expected[i]));
+}
+
+TEST_CASE("gemm", "[blas]")
+{
+    using xprec::SimdLevel;
+    SimdLevel orig = xprec::simd_level();
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::AVX2,
+                                SimdLevel::AVX512};
+
+    for (SimdLevel level : levels) {
+        xprec::set_simd_level(level);
+        for (Transpose ta : {Transpose::NO, Transpose::YES}) {
+            for (Transpose tb : {Transpose::NO, Transpose::YES}) {
+                check_gemm(ta, tb, 7, 5, 3, 1.0, 1.0);
+                check_gemm(ta, tb, 1, 1, 1, 1.0, 0.0);
+                check_gemm(ta, tb, 21, 21, 21, 1.0, 1.0);
+                check_gemm(ta, tb, 9, 6, 300, -0.25, 0.0);
+                check_gemm(ta, tb, 70, 13, 17, DDouble(0.3, 1e-18), 2.0);
+            }
+        }
+        check_gemm(Transpose::NO, Transpose::NO, 3, 4, 0, 1.0, 3.0);
+        check_gemm(Transpose::NO, Transpose::NO, 3, 4, 5, 0.0, -1.0);
+    }
+    xprec::set_simd_level(orig);
+}
+
+TEST_CASE("gemm threads", "[blas]")
+{
+    // The result must not depend on how the tiles are distributed
+    REQUIRE(xprec::set_gemm_threads(0) >= 1);
+
+    std::mt19937 rng;
+    const size_t m = 150, n = 300, k = 280;
+    std::vector<DDouble> a = random_matrix(m * k, rng);
+    std::vector<DDouble> b = random_matrix(k * n, rng);
+    std::vector<DDouble> c1(m * n), c4(m * n);
+
+    REQUIRE(xprec::set_gemm_threads(1) == 1);
+    xprec::gemm(Transpose::NO, Transpose::NO, m, n, k, 1.0, a.data(), m,
+                b.data(), k, 0.0, c1.data(), m);
+
+    REQUIRE(xprec::set_gemm_threads(4) == 4);
+    xprec::gemm(Transpose::NO, Transpose::NO, m, n, k, 1.0, a.data(), m,
+                b.data(), k, 0.0, c4.data(), m);
+
+    for (size_t i = 0; i != c1.size(); ++i)
+        REQUIRE(identical(c1[i], c4[i]));
+
+    xprec::set_gemm_threads(0);
+}
@@ -6,6 +6,8 @@
 #include "catch2-addons.hpp"
 #include "mpfloat.hpp"
 #include "xprec/ddouble.hpp"
+#include "xprec/numbers.hpp"
+#include "xprec/random.hpp"
 #include <catch2/catch_test_macros.hpp>
 
 MPFloat trig_complement(MPFloat x) { return sqrt(1 - x * x); }
@@ -71,6 +73,72 @@ TEST_CASE("cos", "[trig]")
     }
 }
 
+TEST_CASE("sincos", "[trig]")
+{
+    const double ulp = 2.4651903288156619e-32;
+
+    DDouble x = M_PI / 4;
+    while ((x *= 0.9) > 1e-290) {
+        DDouble s, c;
+        xprec::sincos(x, s, c);
+        REQUIRE_THAT(s, WithinRel(sin(MPFloat(x)), ulp));
+        REQUIRE_THAT(c, WithinRel(cos(MPFloat(x)), ulp));
+    }
+
+    // Same reduction as sin and cos for large values
+    x = M_PI / 4;
+    while ((x *= 1.07) < 1e6) {
+        for (DDouble y : {x, -x}) {
+            DDouble s, c;
+            xprec::sincos(y, s, c);
+            REQUIRE(s == sin(y));
+            REQUIRE(c == cos(y));
+        }
+    }
+
+    // Around the nodes of the table, where the reduction cancels
+    for (int k = 1; k <= 64; ++k) {
+        DDouble y = k * xprec::numbers::pi / 64 + 1e-20;
+        CMP_UNARY_ABS(sin, y, 1.5 * ulp);
+        CMP_UNARY_ABS(cos, y, 1.5 * ulp);
+    }
+
+    DDouble s, c;
+    xprec::sincos(INFINITY, s, c);
+    REQUIRE(isnan(s));
+    REQUIRE(isnan(c));
+}
+
+TEST_CASE("sincos large", "[trig]")
+{
+    const double ulp = 2.4651903288156619e-32;
+
+    // Beyond 1e12 or so, the reduction must compute the quotient by pi/64
+    // in DDouble.  The results can only be accurate to the magnitude of x.
+    DDouble x = 1e6;
+    while ((x *= 1.37) < 1e22) {
+        DDouble y = x + DDouble(0.0, ldexp(x.hi(), -70));
+        CMP_UNARY_ABS(sin, y, 1.5 * ulp * fabs(y.hi()));
+        CMP_UNARY_ABS(cos, y, 1.5 * ulp * fabs(y.hi()));
+        CMP_UNARY_ABS(sin, -y, 1.5 * ulp * fabs(y.hi()));
+        CMP_UNARY_ABS(cos, -y, 1.5 * ulp * fabs(y.hi()));
+    }
+    for (double y : {1e15, 1e17, 1e22}) {
+        CMP_UNARY_ABS(sin, y, 1.5 * ulp * y);
+        CMP_UNARY_ABS(cos, y, 1.5 * ulp * y);
+    }
+
+    // Here, pi/64 is no longer resolved, but sin and cos must be bounded
+    for (double y : {1e30, 1e100, 1e300, DBL_MAX}) {
+        DDouble s, c;
+        xprec::sincos(DDouble(y, y * 1e-20), s, c);
+        REQUIRE(fabs(s) <= 1.0);
+        REQUIRE(fabs(c) <= 1.0);
+        REQUIRE(fabs(sin(DDouble(-y))) <= 1.0);
+        REQUIRE(fabs(cos(DDouble(-y))) <= 1.0);
+    }
+}
+
 TEST_CASE("tan", "[trig]")
 {
     const double ulp = 2.4651903288156619e-32;
@@ -164,6 +232,14 @@ TEST_CASE("atan", "[trig]")
         CMP_UNARY(atan, x, 1e-31);
         CMP_UNARY(atan, -x, 1e-31);
     }
+
+    // Around the nodes k/64 of the table and the midpoints between them
+    for (int k = 0; k <= 128; ++k) {
+        DDouble x = k / 128.0 + 1e-17;
+        CMP_UNARY(atan, x, 1e-31);
+        CMP_UNARY(atan, -x, 1e-31);
+        CMP_UNARY(atan, reciprocal(x), 1e-31);
+    }
 }
 
 TEST_CASE("atan2", "[trig]")
@@ -178,4 +254,30 @@ TEST_CASE("atan2", "[trig]")
     CMP_BINARY(atan2, 0.5, -0.5, 1e-31);
     CMP_BINARY(atan2, -0.5, 0.5, 1e-31);
     CMP_BINARY(atan2, -0.5, -0.5, 1e-31);
+
+    // Infinities
+    using xprec::numbers::pi;
+    using xprec::numbers::pi_4;
+    REQUIRE(atan2(DDouble(INFINITY), DDouble(INFINITY)) == pi_4);
+    REQUIRE(atan2(DDouble(-INFINITY), DDouble(-INFINITY)) == -(pi - pi_4));
+    REQUIRE(atan2(DDouble(-1.0), DDouble(-INFINITY)) == -pi);
+    REQUIRE(atan2(DDouble(1.0), DDouble(INFINITY)) == 0.0);
+    REQUIRE(atan2(DDouble(INFINITY), DDouble(-3.0)) == xprec::numbers::pi_half);
+    REQUIRE(isnan(atan2(DDouble(NAN), DDouble(1.0))));
+
+    // All octants, away from and close to their boundaries
+    std::mt19937 rng;
+    std::uniform_real_distribution<DDouble> dist(-4.0, 4.0);
+    for (int i = 0; i != 1000; ++i) {
+        DDouble y = dist(rng), x = dist(rng);
+        CMP_BINARY(atan2, y, x, 1e-31);
+        CMP_BINARY(atan2, y, y + 1e-20, 1e-31);
+        CMP_BINARY(atan2, y, -y - 1e-20, 1e-31);
+    }
+
+    // Large and small magnitudes
+    CMP_BINARY(atan2, 1e300, 3e300, 1e-31);
+    CMP_BINARY(atan2, -1e308, 1.5e308, 1e-31);
+    CMP_BINARY(atan2, 1e-300, 3e-300, 1e-31);
+    CMP_BINARY(atan2, 1e-300, 1e-100, 1e-31);
 }
@@ -32,6 +32,18 @@ TEST_CASE("prod", "[eigen]")
 
     auto A2 = A * A;
     REQUIRE(A2.sum() > 0);
+
+    // Large products go through xprec::gemm (Eigen 3.4), so compare with
+    // coefficient-wise evaluation, also for transposed and row-major operands.
+    Eigen::Matrix<DDouble, Dynamic, Dynamic, Eigen::RowMajor> B = A * 0.75;
+    Eigen::Matrix<DDouble, Dynamic, Dynamic> C = A * B.transpose();
+    Eigen::Matrix<DDouble, Dynamic, Dynamic> C_ref =
+            A.lazyProduct(B.transpose());
+    REQUIRE((C - C_ref).norm() < 1e-30 * C_ref.norm());
+
+    C = A.transpose() * B;
+    C_ref = A.transpose().lazyProduct(B);
+    REQUIRE((C - C_ref).norm() < 1e-30 * C_ref.norm());
 }
 
 TEST_CASE("singular values", "[eigen]")
@@ -53,3 +65,29 @@ TEST_CASE("singular values", "[eigen]")
     auto reconstruction_error = diff.norm();
     REQUIRE(reconstruction_error < 1e-29);
 }
+
+TEST_CASE("packet", "[eigen]")
+{
+    // Odd size exercises both the packet path and the scalar remainder
+    Eigen::Array<DDouble, Dynamic, 1> x(23), y(23);
+    for (int i = 0; i != x.size(); ++i) {
+        x(i) = xprec::reciprocal(xprec::ExDouble(i + 3)) * (i % 3 - 1.25);
+        y(i) = xprec::sqrt(DDouble(i + 2));
+    }
+
+    Eigen::Array<DDouble, Dynamic, 1> s = x + y, d = x - y, p = x * y,
+                                      q = x / y, a = x.abs(), n = -x;
+    for (int i = 0; i != x.size(); ++i) {
+        REQUIRE(s(i) == x(i) + y(i));
+        REQUIRE(d(i) == x(i) - y(i));
+        REQUIRE(p(i) == x(i) * y(i));
+        REQUIRE(q(i) == x(i) / y(i));
+        REQUIRE(a(i) == fabs(x(i)));
+        REQUIRE(n(i) == -x(i));
+    }
+
+    DDouble dot = 0;
+    for (int i = 0; i != x.size(); ++i)
+        dot += x(i) * y(i);
+    CHECK_THAT(x.matrix().dot(y.matrix()), WithinRel(dot, 1e-30));
+}
@@ -5,6 +5,7 @@
  */
 #include "catch2-addons.hpp"
 #include "mpfloat.hpp"
+#include "xprec/array.hpp"
 #include "xprec/ddouble.hpp"
 #include <catch2/catch_test_macros.hpp>
 
@@ -25,6 +26,45 @@ TEST_CASE("pow", "[fn]")
                  WithinRel(pow(DDouble(-2.25), 100), 1e-30));
 }
 
+TEST_CASE("pow real", "[fn]")
+{
+    // Integral and half-integral exponents take the fast paths
+    REQUIRE(pow(DDouble(1.5), DDouble(7.0)) == pow(DDouble(1.5), 7));
+    REQUIRE(pow(DDouble(-2.25), DDouble(-3.0)) == pow(DDouble(-2.25), -3));
+    REQUIRE(pow(DDouble(3.0), DDouble(0.5)) == sqrt(DDouble(3.0)));
+    REQUIRE(pow(DDouble(3.0), DDouble(-0.5)) ==
+            reciprocal(sqrt(DDouble(3.0))));
+    CMP_BINARY(pow, 2.5, 3.5, 1e-31);
+    CMP_BINARY(pow, 0.75, -4.5, 1e-31);
+
+    // Larger integral exponents of negative numbers
+    CMP_BINARY(pow, -1.25, 21.0, 1e-31);
+    CMP_BINARY(pow, -1.25, 40.0, 1e-31);
+    REQUIRE(pow(DDouble(-1.25), DDouble(21.0)) < 0);
+
+    // General case, where y log(x) is large
+    CMP_BINARY(pow, 3.25, 40.3, 1e-31);
+    CMP_BINARY(pow, 0.0625, -100.7, 1e-31);
+    DDouble y = reciprocal(DDouble(3.0)) * 200.0;
+    REQUIRE_THAT(pow(DDouble(10.0), y),
+                 WithinRel(pow(MPFloat(10.0), MPFloat(y)), 1e-31));
+
+    // Small exponents, but results close to or beyond the range of double
+    CMP_BINARY(pow, 1e-200, -1.5, 1e-31);
+    CMP_BINARY(pow, 1e100, 3.0, 1e-31);
+    CMP_BINARY(pow, -1e100, 3.0, 1e-31);
+    CMP_BINARY(pow, 1e-100, 2.5, 1e-31);
+    REQUIRE(pow(DDouble(1e200), DDouble(-2.0)) == 0);
+    REQUIRE(pow(DDouble(1e300), DDouble(-3.0)) == 0);
+    REQUIRE(pow(DDouble(1e300), DDouble(-1.5)) == 0);
+    REQUIRE(pow(DDouble(1e-200), DDouble(-2.0)) == INFINITY);
+    REQUIRE(pow(DDouble(1e300), DDouble(1.5)) == INFINITY);
+    REQUIRE(pow(DDouble(1e-300), DDouble(-1.5)) == INFINITY);
+    REQUIRE(pow(DDouble(-1e200), DDouble(3.0)) == -INFINITY);
+    REQUIRE(pow(DDouble(2.0), DDouble(1024.0)) == INFINITY);
+    REQUIRE(pow(DDouble(2.0), DDouble(1024.0)).lo() == 0);
+}
+
 TEST_CASE("exp", "[exp]")
 {
     const double ulp = 2.4651903288156619e-32;
@@ -39,14 +79,27 @@ TEST_CASE("exp", "[exp]")
         CMP_UNARY(exp, -x, 1.0 * ulp);
     }
 
-    // Larger, less so, but let's still strive for 1 ulps
+    // Larger, less so, but let's still strive for 1 ulps.  Without FMA, the
+    // multiplications are less accurate.
+    const double eps_large = (XPREC_USE_FMA ? 2.0 : 2.5) * ulp;
     x = 0.125;
     while ((x *= 1.0041) < 708.0) {
-        CMP_UNARY(exp, x, 2.0 * ulp);
+        CMP_UNARY(exp, x, eps_large);
         if (x < 670)
-            CMP_UNARY(exp, -x, 2.0 * ulp);
+            CMP_UNARY(exp, -x, eps_large);
     }
 
+    // Close to overflow and down to the subnormal range, as far as the
+    // precision of the result allows
+    CMP_UNARY(exp, 709.75, eps_large);
+    CMP_UNARY(exp, -708.5, 2e-16);
+    for (double y : {-720.0, -740.0, -745.0}) {
+        double r = exp(DDouble(y)).hi();
+        REQUIRE(std::fabs(r / std::exp(y) - 1) < 1e-2);
+    }
+
+    REQUIRE(isinf(exp(DDouble(709.8))));
+    REQUIRE(exp(DDouble(-746)) == 0);
     REQUIRE(exp(DDouble(-1000)) == 0);
 }
 
@@ -64,12 +117,14 @@ TEST_CASE("expm1", "[exp]")
         CMP_UNARY(expm1, -x, 1.5 * ulp);
     }
 
-    // Larger, less so, but let's still strive for 1 ulps
+    // Larger, less so, but let's still strive for 1 ulps.  Without FMA, the
+    // error of exp(x) is amplified by the cancellation in exp(x) - 1.
+    const double eps_large = (XPREC_USE_FMA ? 2.0 : 4.5) * ulp;
     x = 0.125;
     while ((x *= 1.02) < 708.0) {
-        CMP_UNARY(expm1, x, 2.0 * ulp);
+        CMP_UNARY(expm1, x, eps_large);
         if (x < 670)
-            CMP_UNARY(expm1, -x, 2.0 * ulp);
+            CMP_UNARY(expm1, -x, eps_large);
     }
 }
 
@@ -88,6 +143,17 @@ TEST_CASE("log", "[exp]")
     while ((x *= 0.95) > 1e-290) {
         CMP_UNARY(log, x, 1.0 * ulp);
     }
+
+    // Around the nodes of the table, where the reduction cancels
+    for (int k = -40; k <= 56; ++k) {
+        x = 1.0 + k / 128.0 + 1e-17;
+        CMP_UNARY(log, x, 1.0 * ulp);
+        CMP_UNARY(log, ldexp(x, -1060), 1.0 * ulp);
+    }
+
+    REQUIRE(log(DDouble(0.0)) == -INFINITY);
+    REQUIRE(isnan(log(DDouble(-1.0))));
+    REQUIRE(log(DDouble(INFINITY)) == INFINITY);
 }
 
 TEST_CASE("log1p", "[exp]")
@@ -109,4 +175,45 @@ TEST_CASE("log1p", "[exp]")
     while ((x *= 0.92) > 1e-290) {
         CMP_UNARY(log1p, x, 1.0 * ulp);
     }
+
+    // Around the threshold of the direct evaluation
+    for (int k = -8; k <= 8; ++k) {
+        x = 0.0055 * (1 + k / 64.0) + 1e-21;
+        CMP_UNARY(log1p, x, 1.0 * ulp);
+        CMP_UNARY(log1p, -x, 1.0 * ulp);
+    }
+
+    REQUIRE(log1p(DDouble(-1.0)) == -INFINITY);
+    REQUIRE(log1p(DDouble(INFINITY)) == INFINITY);
+}
+
+static void check_dispatched()
+{
+    const double ulp = 2.4651903288156619e-32;
+    DDouble x = 0.125;
+    while ((x *= 1.37) < 700.0) {
+        CMP_UNARY(exp, x, 2.5 * ulp);
+        CMP_UNARY(log, x, 1.0 * ulp);
+        CMP_UNARY_ABS(sin, x, 1.5 * ulp * fabs(x.hi()));
+        CMP_UNARY(cosh, x, 5e-32);
+        CMP_UNARY(sqrt, x, 2.0 * ulp);
+    }
+}
+
+TEST_CASE("dispatch", "[exp]")
+{
+    // The mathematical functions are compiled with and without FMA and
+    // dispatched based on the SIMD level.  Check both variants.
+    using xprec::SimdLevel;
+    SimdLevel orig = xprec::simd_level();
+
+    SECTION("generic") {
+        xprec::set_simd_level(SimdLevel::SCALAR);
+        check_dispatched();
+    }
+    SECTION("fma") {
+        xprec::set_simd_level(SimdLevel::AVX2);
+        check_dispatched();
+    }
+    xprec::set_simd_level(orig);
 }
@@ -0,0 +1,63 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "catch2-addons.hpp"
+#include "mpfloat.hpp"
+#include "xprec/ddouble.hpp"
+#include "xprec/fast-ddouble.hpp"
+#include "xprec/random.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+using xprec::DDouble;
+using xprec::FastDDouble;
+
+TEST_CASE("fast arith", "[fast]")
+{
+    const double u = 0.5 * std::numeric_limits<double>::epsilon();
+#if XPREC_USE_FMA
+    const double eps_mul = 5 * u * u;
+#else
+    const double eps_mul = 7 * u * u;
+#endif
+    std::mt19937 rng;
+    std::uniform_real_distribution<DDouble> dist(0.5, 4.0);
+
+    for (int i = 0; i != 10000; ++i) {
+        DDouble x = dist(rng), y = dist(rng);
+        FastDDouble fx(x), fy(y);
+        MPFloat mx = x, my = y;
+
+        REQUIRE_THAT(DDouble(fx + fy), WithinRel(mx + my, 3 * u * u));
+        REQUIRE_THAT(DDouble(fx * fy), WithinRel(mx * my, eps_mul));
+        REQUIRE_THAT(DDouble(fx / fy), WithinRel(mx / my, 10 * u * u));
+        REQUIRE_THAT(DDouble(reciprocal(fy)), WithinRel(1 / my, 6 * u * u));
+
+        // Cancellation is bounded relative to the magnitudes
+        REQUIRE_THAT(DDouble(fx - fy),
+                     WithinAbs(mx - my, 3 * u * u * (x + y)));
+
+        // Operations with double are the same as for DDouble
+        REQUIRE(DDouble(fx + y.hi()) == x + y.hi());
+        REQUIRE(DDouble(fx * y.hi()) == x * y.hi());
+        REQUIRE(DDouble(fx / y.hi()) == x / y.hi());
+    }
+}
+
+TEST_CASE("fast convert", "[fast]")
+{
+    DDouble x = reciprocal(DDouble(3.0));
+    FastDDouble fx(x);
+    REQUIRE(fx.hi() == x.hi());
+    REQUIRE(fx.lo() == x.lo());
+    REQUIRE(DDouble(fx) == x);
+
+    FastDDouble y = 2.0;
+    y -= fx;
+    y *= 3.0;
+    REQUIRE(y > 4.9);
+    REQUIRE(y < 5.1);
+    REQUIRE(-y == FastDDouble(-DDouble(y)));
+    REQUIRE(FastDDouble(1.5) != 1.0);
+}
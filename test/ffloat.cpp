@@ -0,0 +1,93 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "catch2-addons.hpp"
+#include "mpfloat.hpp"
+#include "xprec/ddouble.hpp"
+#include "xprec/ffloat.hpp"
+#include "xprec/random.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+using xprec::DDouble;
+using xprec::FFloat;
+using ff_limits = std::numeric_limits<FFloat>;
+
+static const double u_f = 0.5 * std::numeric_limits<float>::epsilon();
+
+static FFloat to_ffloat(DDouble x) { return FFloat(x); }
+
+TEST_CASE("ffloat arith", "[ffloat]")
+{
+#if XPREC_USE_FMA
+    const double eps_mul = 4 * u_f * u_f;
+#else
+    const double eps_mul = 7 * u_f * u_f;
+#endif
+    std::mt19937 rng;
+    std::uniform_real_distribution<DDouble> dist(-4.0, 4.0);
+
+    for (int i = 0; i != 10000; ++i) {
+        FFloat x = to_ffloat(dist(rng)), y = to_ffloat(dist(rng));
+        float z = (float)to_ffloat(dist(rng));
+        MPFloat mx = DDouble(x), my = DDouble(y);
+
+        REQUIRE_THAT(DDouble(x + y), WithinRel(mx + my, 3 * u_f * u_f));
+        REQUIRE_THAT(DDouble(x - z), WithinRel(mx - z, 2 * u_f * u_f));
+        REQUIRE_THAT(DDouble(x * y), WithinRel(mx * my, eps_mul));
+        REQUIRE_THAT(DDouble(x * z), WithinRel(mx * z, eps_mul));
+        REQUIRE_THAT(DDouble(x / z), WithinRel(mx / z, 3 * u_f * u_f));
+        REQUIRE_THAT(DDouble(x / y), WithinRel(mx / my, 6 * u_f * u_f));
+        REQUIRE_THAT(DDouble(reciprocal(y)),
+                     WithinRel(1 / my, 2 * u_f * u_f));
+        REQUIRE_THAT(DDouble(sqrt(abs(x))),
+                     WithinRel(sqrt(abs(mx)), 3 * u_f * u_f));
+    }
+}
+
+TEST_CASE("ffloat convert", "[ffloat]")
+{
+    DDouble x = reciprocal(DDouble(3.0));
+    FFloat fx(x);
+    REQUIRE((double)fx.hi() + fx.lo() == fx.as<double>());
+    REQUIRE_THAT(DDouble(fx), WithinRel(x, u_f * u_f));
+    REQUIRE(FFloat(DDouble(fx)) == fx);
+    REQUIRE(FFloat(x.hi()) == fx);
+
+    REQUIRE(isinf(FFloat(1e300)));
+    REQUIRE(isnan(FFloat(DDouble(NAN))));
+    REQUIRE(FFloat(2.5) == 2.5f);
+}
+
+TEST_CASE("ffloat functions", "[ffloat]")
+{
+    const double eps = 2 * u_f * u_f;
+    FFloat x = FFloat(0.375) / 3.0f;
+    MPFloat mx = DDouble(x);
+
+    REQUIRE_THAT(DDouble(exp(x)), WithinRel(exp(mx), eps));
+    REQUIRE_THAT(DDouble(log(x)), WithinRel(log(mx), eps));
+    REQUIRE_THAT(DDouble(sin(x)), WithinRel(sin(mx), eps));
+    REQUIRE_THAT(DDouble(cos(x)), WithinRel(cos(mx), eps));
+    REQUIRE_THAT(DDouble(atan(x)), WithinRel(atan(mx), eps));
+    REQUIRE_THAT(DDouble(tanh(x)), WithinRel(tanh(mx), eps));
+}
+
+TEST_CASE("ffloat limits", "[ffloat]")
+{
+    const float eps_f = std::numeric_limits<float>::epsilon();
+    const FFloat almost_one(1.0f, eps_f / 2);
+    REQUIRE(almost_one + ff_limits::epsilon() != almost_one);
+    REQUIRE(almost_one - ff_limits::epsilon() != almost_one);
+    REQUIRE(almost_one + 0.25f * ff_limits::epsilon() == almost_one);
+
+    REQUIRE(ff_limits::max() > 0.0f);
+    REQUIRE(isfinite(ff_limits::max()));
+    REQUIRE(ff_limits::max() + 0.0f == ff_limits::max());
+    REQUIRE(ff_limits::lowest() == -ff_limits::max());
+    REQUIRE(ff_limits::min() > 0.0f);
+    REQUIRE(isinf(ff_limits::infinity()));
+    REQUIRE(isnan(ff_limits::quiet_NaN()));
+    REQUIRE(ff_limits::digits == 49);
+}
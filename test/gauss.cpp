@@ -82,10 +82,13 @@ TEST_CASE("leg-cmp-16", "[gauss]")
         {0.062253523938647894, -7.690264522605704e-19},
         {0.027152459411754096, -1.56154670271636e-18}};
 
+    // Without FMA, the multiplications are less accurate
+    const double w_eps = XPREC_USE_FMA ? 0.2e-31 : 0.3e-31;
+
     std::vector<DDouble> x(16), w(16);
     gauss_legendre(16, x.data(), w.data());
     for (int i = 0; i < 16; ++i) {
         REQUIRE_THAT(x[i], WithinAbs(x_ref[i], 5e-32));
-        REQUIRE_THAT(w[i], WithinAbs(w_ref[i], 0.2 * 1e-31));
+        REQUIRE_THAT(w[i], WithinAbs(w_ref[i], w_eps));
     }
 }
@@ -25,6 +25,12 @@ TEST_CASE("cosh", "[hyp]")
         CMP_UNARY(cosh, x, 5e-32);
         CMP_UNARY(cosh, -x, 5e-32);
     }
+
+    // Beyond the range of exp(x), but not of exp(x)/2
+    CMP_UNARY(cosh, 709.9, 5e-32);
+    CMP_UNARY(cosh, -710.0, 5e-32);
+    REQUIRE(cosh(DDouble(711.0)) == INFINITY);
+    REQUIRE(cosh(DDouble(-1000.0)) == INFINITY);
 }
 
 TEST_CASE("sinh", "[hyp]")
@@ -37,18 +43,60 @@ TEST_CASE("sinh", "[hyp]")
         CMP_UNARY(sinh, -x, 5e-32);
     }
 
-    // XXX improve precision here a little
     x = 0.15;
-    while ((x *= 1.0041) < 1.0) {
-        CMP_UNARY(sinh, x, 2e-31);
-        CMP_UNARY(sinh, -x, 2e-31);
-    }
-
-    // This is fine.
     while ((x *= 1.0041) < 708.0) {
         CMP_UNARY(sinh, x, 5e-32);
         CMP_UNARY(sinh, -x, 5e-32);
     }
+
+    // Beyond the range of exp(x), but not of exp(x)/2
+    CMP_UNARY(sinh, 709.9, 5e-32);
+    CMP_UNARY(sinh, -710.0, 5e-32);
+    REQUIRE(sinh(DDouble(1000.0)) == INFINITY);
+    REQUIRE(sinh(DDouble(-711.0)) == -INFINITY);
+}
+
+TEST_CASE("sinhcosh", "[hyp]")
+{
+    // Same results as sinh and cosh
+    DDouble x = 0.25;
+    while ((x *= 0.9) > 1e-290) {
+        for (DDouble y : {x, -x}) {
+            DDouble s, c;
+            xprec::sinhcosh(y, s, c);
+            REQUIRE(s == sinh(y));
+            REQUIRE(c == cosh(y));
+        }
+    }
+
+    x = 0.125;
+    while ((x *= 1.0041) < 708.0) {
+        for (DDouble y : {x, -x}) {
+            DDouble s, c;
+            xprec::sinhcosh(y, s, c);
+            REQUIRE(s == sinh(y));
+            REQUIRE(c == cosh(y));
+        }
+    }
+
+    for (DDouble y : {709.9, -710.0, 711.0, -1000.0}) {
+        DDouble s, c;
+        xprec::sinhcosh(y, s, c);
+        REQUIRE(s == sinh(y));
+        REQUIRE(c == cosh(y));
+    }
+
+    // Special values
+    DDouble s, c;
+    xprec::sinhcosh(711.0, s, c);
+    REQUIRE(s == INFINITY);
+    REQUIRE(c == INFINITY);
+    xprec::sinhcosh(-INFINITY, s, c);
+    REQUIRE(s == -INFINITY);
+    REQUIRE(c == INFINITY);
+    xprec::sinhcosh(NAN, s, c);
+    REQUIRE(isnan(s));
+    REQUIRE(isnan(c));
 }
 
 TEST_CASE("tanh", "[hyp]")
@@ -62,6 +110,13 @@ TEST_CASE("tanh", "[hyp]")
         CMP_UNARY(tanh, -x, 5e-32);
     }
 
+    // Around the switch from the kernel to expm1
+    for (int k = -8; k <= 8; ++k) {
+        x = 0.2 + k * 1e-4 + 1e-20;
+        CMP_UNARY(tanh, x, 5e-32);
+        CMP_UNARY(tanh, -x, 5e-32);
+    }
+
     x = 0.2;
     while ((x *= 1.05) < 1e300) {
         CMP_UNARY(tanh, x, 8e-32);
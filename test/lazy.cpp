@@ -0,0 +1,78 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "catch2-addons.hpp"
+#include "mpfloat.hpp"
+#include "xprec/ddouble.hpp"
+#include "xprec/lazy.hpp"
+#include "xprec/random.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <type_traits>
+
+using xprec::DDouble;
+using xprec::lazy;
+
+TEST_CASE("lazy types", "[lazy]")
+{
+    DDouble a = 1.5, b = 2.0;
+    auto e = lazy(a) * b + a * b - 1.0;
+    static_assert(!std::is_same<decltype(e), DDouble>::value, "not lazy");
+    static_assert(std::is_same<decltype(a * b), DDouble>::value, "lazy");
+
+    // Operands are copied, so they can change afterwards
+    a = 0.0;
+    REQUIRE(DDouble(e) == 5.0);
+    REQUIRE(e.eval() == 5.0);
+    REQUIRE(DDouble(-lazy(a) - 2 * lazy(b) / 4.0) == -1.0);
+    REQUIRE(DDouble((lazy(b) + 1.0) * (b + lazy(1.0))) == 9.0);
+}
+
+TEST_CASE("lazy accuracy", "[lazy]")
+{
+    const double u = 0.5 * std::numeric_limits<double>::epsilon();
+    const double uu = u * u;
+    std::mt19937 rng;
+    std::uniform_real_distribution<DDouble> dist(-1.0, 1.0);
+
+    // Documented error bound for a sum of k <= RENORM terms, and for the
+    // products: 4u² for DDouble * DDouble, 2u² for DDouble * double.
+    auto sum_bound = [uu](int k) { return (k * (k - 1) / 2 + 4 * k - 1) * uu; };
+#if XPREC_USE_FMA
+    const double eps_dd = 4 * uu, eps_dx = 2 * uu;
+#else
+    const double eps_dd = 7 * uu, eps_dx = 3 * uu;
+#endif
+
+    for (int i = 0; i != 10000; ++i) {
+        DDouble a = dist(rng), b = dist(rng), c = dist(rng), d = dist(rng);
+        DDouble e = ldexp(dist(rng), -3);
+        double f = dist(rng).hi();
+
+        DDouble r = lazy(a) * b + lazy(c) * d - e * f;
+        MPFloat ab = MPFloat(a) * MPFloat(b), cd = MPFloat(c) * MPFloat(d);
+        MPFloat ef = MPFloat(e) * f;
+        MPFloat ref = ab + cd - ef;
+        double mag_ab = fabs(ab.as_ddouble().hi());
+        double mag_cd = fabs(cd.as_ddouble().hi());
+        double mag_ef = fabs(ef.as_ddouble().hi());
+        double mag = mag_ab + mag_cd + mag_ef;
+
+        double tol = sum_bound(3) * mag + eps_dd * (mag_ab + mag_cd)
+                     + eps_dx * mag_ef;
+        REQUIRE_THAT(r, WithinAbs(ref.as_ddouble(), tol));
+
+        // Long expressions are normalized by the accumulator after RENORM
+        // terms, which adds the error of the addition, 3u².
+        DDouble s = lazy(a) + b + c + d + e + f + a * b + c * d + e * f - a;
+        MPFloat sref = MPFloat(b) + MPFloat(c) + MPFloat(d) + MPFloat(e)
+                       + f + ab + cd + ef;
+        double smag = 2 * fabs(a.hi()) + fabs(b.hi()) + fabs(c.hi())
+                      + fabs(d.hi()) + fabs(e.hi()) + fabs(f) + mag;
+        double stol = (sum_bound(xprec::Accumulator::RENORM) + 3 * uu) * smag
+                      + eps_dd * (mag_ab + mag_cd) + eps_dx * mag_ef;
+        REQUIRE_THAT(s, WithinAbs(sref.as_ddouble(), stol));
+    }
+}
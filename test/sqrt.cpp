@@ -40,13 +40,15 @@ TEST_CASE("sqrt", "[fn]")
     CMP_UNARY(sqrt, 0.25, 1.0 * ulp);
     CMP_UNARY(sqrt, 4.0, 1.0 * ulp);
 
+    // Without FMA, the sequence of x is different and hits a worse case
+    const double eps = (XPREC_USE_FMA ? 1.5 : 2.0) * ulp;
     DDouble x = 1.0;
     while ((x *= 0.99) > 1e-290) {
-        CMP_UNARY(sqrt, x, 1.5 * ulp);
+        CMP_UNARY(sqrt, x, eps);
     }
 
     x = 1.0;
     while ((x /= 0.99) <= 1e290) {
-        CMP_UNARY(sqrt, x, 1.5 * ulp);
+        CMP_UNARY(sqrt, x, eps);
     }
 }